@@ -140,20 +140,20 @@ typedef struct laye_ast_modifier
 
 typedef struct laye_ast_struct_variant
 {
-    string name;
+    layec_symbol name;
     list(laye_ast_node*) fieldBindings;
     bool isVoid;
 } laye_ast_struct_variant;
 
 typedef struct laye_ast_enum_variant
 {
-    string name;
+    layec_symbol name;
     laye_ast_node* value;
 } laye_ast_enum_variant;
 
 typedef struct laye_ast_constructor_value
 {
-    string name;
+    layec_symbol name;
     laye_ast_node* value;
 } laye_ast_constructor_value;
 
@@ -162,15 +162,15 @@ typedef struct laye_ast_import
     layec_location location;
 
     // could be sourced from an identifier or a string.
-    string name;
+    layec_symbol name;
     // used to rename the inferred namespace, or to define one where one cannot be inferred otherwise.
     // e.g. `import "std";` creates the namespace `std`, as does `import "my fun library" as std;`.
-    string alias;
+    layec_symbol alias;
 
     // `import * from "std";`
     bool allMembers;
     // `import foo, bar from "std";`
-    list(string) explicitMembers;
+    list(layec_symbol) explicitMembers;
 
     // True if this import should also be publicly exported, false otherwise.
     // e.g. `export import "sublib.laye";`
@@ -192,7 +192,7 @@ typedef enum laye_ast_template_argument_kind
 typedef struct laye_ast_template_parameter
 {
     laye_ast_template_parameter_kind kind;
-    string name;
+    layec_symbol name;
     laye_ast_node* valueType;
 } laye_ast_template_parameter;
 
@@ -215,6 +215,9 @@ typedef enum laye_ast_varargs_kind
     LAYE_AST_VARARGS_C,
 } laye_ast_varargs_kind;
 
+// every node starts with its kind and location, followed by the one member of the union its kind uses.
+// a node is only allocated up to the end of that member, see `laye_ast_node_size`,
+// so nodes must never be copied by value or accessed through the member of another kind.
 struct laye_ast_node
 {
     laye_ast_node_kind kind;
@@ -243,7 +246,7 @@ struct laye_ast_node
 
         struct
         {
-            list(string) path;
+            list(layec_symbol) path;
             list(laye_ast_template_argument) templateArguments;
             bool isHeadless;
             bool isGlobal;
@@ -268,7 +271,7 @@ struct laye_ast_node
         {
             list(laye_ast_modifier) modifiers;
             laye_ast_node* declaredType;
-            string name;
+            layec_symbol name;
             laye_ast_node* initialValue;
         } bindingDeclaration;
 
@@ -276,7 +279,7 @@ struct laye_ast_node
         {
             list(laye_ast_modifier) modifiers;
             laye_ast_node* returnType;
-            string name;
+            layec_symbol name;
             bool isOperator;
             laye_token_kind operator;
             list(laye_ast_template_parameter) templateParameters;
@@ -288,7 +291,7 @@ struct laye_ast_node
         struct
         {
             list(laye_ast_modifier) modifiers;
-            string name;
+            layec_symbol name;
             list(laye_ast_template_parameter) templateParameters;
             list(laye_ast_node*) fieldBindings;
             list(laye_ast_struct_variant) variants;
@@ -297,7 +300,7 @@ struct laye_ast_node
         struct
         {
             list(laye_ast_modifier) modifiers;
-            string name;
+            layec_symbol name;
             list(laye_ast_template_parameter) templateParameters;
             list(laye_ast_enum_variant) variants;
         } enumDeclaration;
@@ -313,12 +316,12 @@ struct laye_ast_node
 
         struct
         {
-            string target;
+            layec_symbol target;
         } _break;
 
         struct
         {
-            string target;
+            layec_symbol target;
         } _continue;
 
         struct
@@ -336,7 +339,7 @@ struct laye_ast_node
 
         struct
         {
-            list(string) path;
+            list(layec_symbol) path;
             list(laye_ast_template_argument) templateArguments;
             bool isHeadless;
             bool isGlobal;
@@ -371,7 +374,7 @@ struct laye_ast_node
         struct
         {
             laye_ast_node* target;
-            string name;
+            layec_symbol name;
         } field_index;
 
         struct
@@ -379,7 +382,7 @@ struct laye_ast_node
             laye_ast_node* lhs;
             laye_ast_node* rhs;
             laye_token_kind operatorKind;
-            string operatorString;
+            layec_symbol operatorString;
         } binary;
 
         struct
@@ -404,7 +407,7 @@ struct laye_ast_node
         struct
         {
             laye_ast_node* target;
-            string captureName;
+            layec_symbol captureName;
             laye_ast_node* body;
         } catch;
     };
@@ -417,9 +420,13 @@ typedef struct laye_ast
     list(laye_ast_node*) topLevelNodes;
 } laye_ast;
 
-string laye_ast_node_type_to_string(laye_ast_node* typeNode);
+string laye_ast_node_type_to_string(layec_context* context, laye_ast_node* typeNode);
 
 string_view laye_ast_node_kind_name(laye_ast_node_kind kind);
+// the number of bytes a node of this kind is allocated with.
+usize laye_ast_node_size(laye_ast_node_kind kind);
 void laye_ast_fprint(FILE* stream, layec_context* context, laye_ast* ast, bool colors);
+// prints the tree as a single line JSON object.
+void laye_ast_fprint_json(FILE* stream, layec_context* context, laye_ast* ast);
 
 #endif // AST_H
@@ -6,9 +6,9 @@
 #include "ast.h"
 #include "token.h"
 
-static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb);
+static void type_to_string_builder(layec_context* context, laye_ast_node* typeNode, string_builder* sb);
 
-static void template_args_to_string_builder(list(laye_ast_template_argument) args, string_builder* sb)
+static void template_args_to_string_builder(layec_context* context, list(laye_ast_template_argument) args, string_builder* sb)
 {
     string_builder_append_cstring(sb, "<");
     for (usize i = 0, iLen = arrlenu(args); i < iLen; i++)
@@ -20,7 +20,7 @@ static void template_args_to_string_builder(list(laye_ast_template_argument) arg
         switch (arg.kind)
         {
             case LAYE_TEMPLATE_ARG_TYPE:
-                type_to_string_builder(arg.value, sb);
+                type_to_string_builder(context, arg.value, sb);
                 break;
 
             case LAYE_TEMPLATE_ARG_VALUE:
@@ -31,7 +31,7 @@ static void template_args_to_string_builder(list(laye_ast_template_argument) arg
     string_builder_append_cstring(sb, ">");
 }
 
-static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
+static void type_to_string_builder(layec_context* context, laye_ast_node* typeNode, string_builder* sb)
 {
     switch (typeNode->kind)
     {
@@ -42,19 +42,19 @@ static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
             if (typeNode->errorUnionType.errorPath != nullptr)
             {
                 assert(typeNode->errorUnionType.errorPath->kind == LAYE_AST_NODE_TYPE_NAMED);
-                type_to_string_builder(typeNode->errorUnionType.errorPath, sb);
+                type_to_string_builder(context, typeNode->errorUnionType.errorPath, sb);
             }
 
             string_builder_append_rune(sb, cast(rune) '!');
             assert(typeNode->errorUnionType.valueType != nullptr);
-            type_to_string_builder(typeNode->errorUnionType.valueType, sb);
+            type_to_string_builder(context, typeNode->errorUnionType.valueType, sb);
         } break;
 
         case LAYE_AST_NODE_TYPE_FUNCTION:
         {
             bool isErrorReturn = typeNode->functionType.returnType->kind == LAYE_AST_NODE_TYPE_ERROR;
             if (isErrorReturn) string_builder_append_rune(sb, cast(rune) '(');
-            type_to_string_builder(typeNode->functionType.returnType, sb);
+            type_to_string_builder(context, typeNode->functionType.returnType, sb);
             if (isErrorReturn) string_builder_append_rune(sb, cast(rune) ')');
             string_builder_append_rune(sb, cast(rune) '(');
             bool isLayeVarargs = typeNode->functionType.varargsKind == LAYE_AST_VARARGS_LAYE;
@@ -64,7 +64,7 @@ static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
                     string_builder_append_cstring(sb, ", ");
                 if (i == iLen - 1 && isLayeVarargs)
                     string_builder_append_cstring(sb, "varargs ");
-                type_to_string_builder(typeNode->functionType.parameterTypes[i], sb);
+                type_to_string_builder(context, typeNode->functionType.parameterTypes[i], sb);
             }
             if (typeNode->functionType.varargsKind == LAYE_AST_VARARGS_C)
                 string_builder_append_cstring(sb, ", varargs");
@@ -75,7 +75,7 @@ static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
 
         case LAYE_AST_NODE_TYPE_POINTER:
         {
-            type_to_string_builder(typeNode->containerType.elementType, sb);
+            type_to_string_builder(context, typeNode->containerType.elementType, sb);
             if (typeNode->containerType.access == LAYE_AST_ACCESS_READONLY)
                 string_builder_append_cstring(sb, " readonly");
             else if (typeNode->containerType.access == LAYE_AST_ACCESS_WRITEONLY)
@@ -90,7 +90,7 @@ static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
 
         case LAYE_AST_NODE_TYPE_SLICE:
         {
-            type_to_string_builder(typeNode->containerType.elementType, sb);
+            type_to_string_builder(context, typeNode->containerType.elementType, sb);
             if (typeNode->containerType.access == LAYE_AST_ACCESS_READONLY)
                 string_builder_append_cstring(sb, " readonly");
             else if (typeNode->containerType.access == LAYE_AST_ACCESS_WRITEONLY)
@@ -105,7 +105,7 @@ static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
 
         case LAYE_AST_NODE_TYPE_BUFFER:
         {
-            type_to_string_builder(typeNode->containerType.elementType, sb);
+            type_to_string_builder(context, typeNode->containerType.elementType, sb);
             if (typeNode->containerType.access == LAYE_AST_ACCESS_READONLY)
                 string_builder_append_cstring(sb, " readonly");
             else if (typeNode->containerType.access == LAYE_AST_ACCESS_WRITEONLY)
@@ -120,7 +120,7 @@ static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
 
         case LAYE_AST_NODE_TYPE_ARRAY:
         {
-            type_to_string_builder(typeNode->containerType.elementType, sb);
+            type_to_string_builder(context, typeNode->containerType.elementType, sb);
             if (typeNode->containerType.access == LAYE_AST_ACCESS_READONLY)
                 string_builder_append_cstring(sb, " readonly");
             else if (typeNode->containerType.access == LAYE_AST_ACCESS_WRITEONLY)
@@ -145,10 +145,10 @@ static void type_to_string_builder(laye_ast_node* typeNode, string_builder* sb)
             {
                 if (i > 0)
                     string_builder_append_cstring(sb, "::");
-                string_builder_append_string(sb, typeNode->lookupType.path[i]);
+                string_builder_append_string(sb, layec_symbol_name(context, typeNode->lookupType.path[i]));
             }
             if (arrlenu(typeNode->lookupType.templateArguments) > 0)
-                template_args_to_string_builder(typeNode->lookupType.templateArguments, sb);
+                template_args_to_string_builder(context, typeNode->lookupType.templateArguments, sb);
             if (typeNode->lookupType.isNilable)
                 string_builder_append_rune(sb, cast(rune) '?');
         } break;
@@ -222,14 +222,15 @@ check_primitive_nilable:;
         string_builder_append_rune(sb, cast(rune) '?');
 }
 
-string laye_ast_node_type_to_string(laye_ast_node* typeNode)
+string laye_ast_node_type_to_string(layec_context* context, laye_ast_node* typeNode)
 {
+    assert(context != nullptr);
     assert(typeNode != nullptr);
 
     string_builder sb = { 0 };
     string_builder_init(&sb, default_allocator);
 
-    type_to_string_builder(typeNode, &sb);
+    type_to_string_builder(context, typeNode, &sb);
 
     return (string){
         .allocator = sb.allocator,
@@ -251,8 +252,115 @@ LAYE_AST_NODE_KINDS
     }
 }
 
-#define PUTCOLOR(C) do { if (state.colors) fprintf(state.stream, C); } while (0)
-#define RESETCOLOR do { if (state.colors) fprintf(state.stream, ANSI_COLOR_RESET); } while (0)
+#define NODE_SIZE(member) (offsetof(laye_ast_node, member) + sizeof(((laye_ast_node*) nullptr)->member))
+#define NODE_HEADER_SIZE offsetof(laye_ast_node, primitiveType)
+
+usize laye_ast_node_size(laye_ast_node_kind kind)
+{
+    switch (kind)
+    {
+        case LAYE_AST_NODE_INVALID:
+        case LAYE_AST_NODE_TYPE_INVALID:
+        case LAYE_AST_NODE_STATEMENT_YIELD_BREAK:
+        case LAYE_AST_NODE_EXPRESSION_NIL:
+            return NODE_HEADER_SIZE;
+
+        case LAYE_AST_NODE_TYPE_INFER:
+        case LAYE_AST_NODE_TYPE_NORETURN:
+        case LAYE_AST_NODE_TYPE_RAWPTR:
+        case LAYE_AST_NODE_TYPE_VOID:
+        case LAYE_AST_NODE_TYPE_STRING:
+        case LAYE_AST_NODE_TYPE_RUNE:
+        case LAYE_AST_NODE_TYPE_BOOL:
+        case LAYE_AST_NODE_TYPE_BOOL_SIZED:
+        case LAYE_AST_NODE_TYPE_INT:
+        case LAYE_AST_NODE_TYPE_INT_SIZED:
+        case LAYE_AST_NODE_TYPE_UINT:
+        case LAYE_AST_NODE_TYPE_UINT_SIZED:
+        case LAYE_AST_NODE_TYPE_FLOAT:
+        case LAYE_AST_NODE_TYPE_FLOAT_SIZED:
+        case LAYE_AST_NODE_TYPE_C_CHAR:
+        case LAYE_AST_NODE_TYPE_C_SCHAR:
+        case LAYE_AST_NODE_TYPE_C_UCHAR:
+        case LAYE_AST_NODE_TYPE_C_STRING:
+        case LAYE_AST_NODE_TYPE_C_SHORT:
+        case LAYE_AST_NODE_TYPE_C_USHORT:
+        case LAYE_AST_NODE_TYPE_C_INT:
+        case LAYE_AST_NODE_TYPE_C_UINT:
+        case LAYE_AST_NODE_TYPE_C_LONG:
+        case LAYE_AST_NODE_TYPE_C_ULONG:
+        case LAYE_AST_NODE_TYPE_C_LONGLONG:
+        case LAYE_AST_NODE_TYPE_C_ULONGLONG:
+        case LAYE_AST_NODE_TYPE_C_SIZE_T:
+        case LAYE_AST_NODE_TYPE_C_PTRDIFF_T:
+        case LAYE_AST_NODE_TYPE_C_FLOAT:
+        case LAYE_AST_NODE_TYPE_C_DOUBLE:
+        case LAYE_AST_NODE_TYPE_C_LONGDOUBLE:
+        case LAYE_AST_NODE_TYPE_C_BOOL:
+            return NODE_SIZE(primitiveType);
+
+        case LAYE_AST_NODE_TYPE_ARRAY:
+        case LAYE_AST_NODE_TYPE_SLICE:
+        case LAYE_AST_NODE_TYPE_POINTER:
+        case LAYE_AST_NODE_TYPE_BUFFER:
+            return NODE_SIZE(containerType);
+
+        case LAYE_AST_NODE_TYPE_NAMED: return NODE_SIZE(lookupType);
+        case LAYE_AST_NODE_TYPE_FUNCTION: return NODE_SIZE(functionType);
+        case LAYE_AST_NODE_TYPE_ERROR: return NODE_SIZE(errorUnionType);
+
+        case LAYE_AST_NODE_BINDING_DECLARATION: return NODE_SIZE(bindingDeclaration);
+        case LAYE_AST_NODE_FUNCTION_DECLARATION: return NODE_SIZE(functionDeclaration);
+        case LAYE_AST_NODE_STRUCT_DECLARATION: return NODE_SIZE(structDeclaration);
+        case LAYE_AST_NODE_ENUM_DECLARATION: return NODE_SIZE(enumDeclaration);
+
+        case LAYE_AST_NODE_STATEMENT_BLOCK: return NODE_SIZE(statements);
+        case LAYE_AST_NODE_STATEMENT_ASSIGNMENT: return NODE_SIZE(assignment);
+        case LAYE_AST_NODE_STATEMENT_IF: return NODE_SIZE(_if);
+        case LAYE_AST_NODE_STATEMENT_BREAK: return NODE_SIZE(_break);
+        case LAYE_AST_NODE_STATEMENT_CONTINUE: return NODE_SIZE(_continue);
+
+        case LAYE_AST_NODE_STATEMENT_WHILE:
+        case LAYE_AST_NODE_STATEMENT_DO_WHILE:
+            return NODE_SIZE(_while);
+
+        case LAYE_AST_NODE_STATEMENT_RETURN:
+        case LAYE_AST_NODE_STATEMENT_YIELD:
+        case LAYE_AST_NODE_STATEMENT_YIELD_RETURN:
+            return NODE_SIZE(returnValue);
+
+        // a lookup followed by a constructor becomes the constructor's named type in place.
+        case LAYE_AST_NODE_EXPRESSION_LOOKUP:
+            return NODE_SIZE(lookup) > NODE_SIZE(lookupType) ? NODE_SIZE(lookup) : NODE_SIZE(lookupType);
+
+        case LAYE_AST_NODE_EXPRESSION_BINARY: return NODE_SIZE(binary);
+        case LAYE_AST_NODE_EXPRESSION_INVOKE: return NODE_SIZE(invoke);
+        case LAYE_AST_NODE_EXPRESSION_TRY: return NODE_SIZE(try);
+        case LAYE_AST_NODE_EXPRESSION_CATCH: return NODE_SIZE(catch);
+        case LAYE_AST_NODE_EXPRESSION_CONSTRUCTOR: return NODE_SIZE(constructor);
+        case LAYE_AST_NODE_EXPRESSION_SLICE: return NODE_SIZE(slice);
+        case LAYE_AST_NODE_EXPRESSION_INDEX: return NODE_SIZE(container_index);
+        case LAYE_AST_NODE_EXPRESSION_FIELD_INDEX: return NODE_SIZE(field_index);
+        case LAYE_AST_NODE_EXPRESSION_NEW: return NODE_SIZE(new);
+
+        case LAYE_AST_NODE_EXPRESSION_BOOL:
+        case LAYE_AST_NODE_EXPRESSION_STRING:
+        case LAYE_AST_NODE_EXPRESSION_INTEGER:
+            return NODE_SIZE(literal);
+
+        // kinds the parser doesn't produce yet get room for any member.
+        default: return sizeof(laye_ast_node);
+    }
+}
+
+#undef NODE_HEADER_SIZE
+#undef NODE_SIZE
+
+#define PUTCOLOR(C) do { if (state.colors) string_builder_append_cstring(state.output, C); } while (0)
+#define RESETCOLOR do { if (state.colors) string_builder_append_cstring(state.output, ANSI_COLOR_RESET); } while (0)
+
+// the dump is rendered into `output` and written once this much has built up, so large trees take few writes.
+#define AST_FPRINT_FLUSH_SIZE (64 * 1024)
 
 typedef struct ast_fprint_state
 {
@@ -261,20 +369,37 @@ typedef struct ast_fprint_state
     laye_ast* ast;
     bool colors;
     string_builder* indents;
+    string_builder* output;
 } ast_fprint_state;
 
+static void laye_ast_fprint_flush(ast_fprint_state state)
+{
+    if (state.output->count == 0)
+        return;
+
+    fwrite(state.output->memory, 1, state.output->count, state.stream);
+    // the stream may be buffered while diagnostics aren't, flushing keeps the two in order.
+    fflush(state.stream);
+    string_builder_set_count(state.output, 0);
+}
+
 static void laye_ast_fprint_name(ast_fprint_state state, string_view name, bool isLast)
 {
+    // every line starts here, so the output is never flushed part way through one.
+    if (state.output->count >= AST_FPRINT_FLUSH_SIZE)
+        laye_ast_fprint_flush(state);
+
     if (state.indents->count > 0)
     {
-        fprintf(state.stream, "%.*s", (int)state.indents->count, cast(const char*)state.indents->memory);
+        string_view indents = { .memory = state.indents->memory, .count = state.indents->count };
+        string_builder_append_view(state.output, indents);
     }
 
     const char* currentIndent = isLast ? "└ " : "├ ";
 
-    fprintf(state.stream, "%s", currentIndent);
+    string_builder_append_cstring(state.output, currentIndent);
     PUTCOLOR(ANSI_COLOR_RED);
-    fprintf(state.stream, STRING_VIEW_FORMAT, STRING_VIEW_EXPAND(name));
+    string_builder_append_view(state.output, name);
     RESETCOLOR;
 }
 
@@ -288,38 +413,38 @@ static void laye_ast_fprint_template_parameter(ast_fprint_state state, laye_ast_
         case LAYE_TEMPLATE_PARAM_VALUE:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Name: ");
+            string_builder_append_cstring(state.output, "Name: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(param.name));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, param.name));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, "> <");
+            string_builder_append_cstring(state.output, "> <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Type: ");
+            string_builder_append_cstring(state.output, "Type: ");
             RESETCOLOR;
-            string typeString = laye_ast_node_type_to_string(param.valueType);
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(typeString));
+            string typeString = laye_ast_node_type_to_string(state.context, param.valueType);
+            string_builder_append_string(state.output, typeString);
             string_deallocate(typeString);
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_TEMPLATE_PARAM_TYPE:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Name: ");
+            string_builder_append_cstring(state.output, "Name: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(param.name));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, param.name));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
     }
 
     RESETCOLOR;
-    fprintf(state.stream, "\n");
+    string_builder_append_cstring(state.output, "\n");
 }
 
 static void laye_ast_fprint_node(ast_fprint_state state, laye_ast_node* node, bool isLast);
@@ -329,7 +454,7 @@ static void laye_ast_fprint_template_argument(ast_fprint_state state, laye_ast_t
     laye_ast_fprint_name(state, STRING_VIEW_LITERAL("TEMPLATE_ARGUMENT"), isLast);
 
     RESETCOLOR;
-    fprintf(state.stream, "\n");
+    string_builder_append_cstring(state.output, "\n");
 
     usize lastStringBuilderCount = state.indents->count;
     string_builder_append_cstring(state.indents, isLast ? "  " : "│ ");
@@ -346,15 +471,15 @@ static void laye_ast_fprint_template_argument(ast_fprint_state state, laye_ast_t
         {
             laye_ast_fprint_name(state, STRING_VIEW_LITERAL("TYPE_PARAMETER"), isLast);
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Name: ");
+            string_builder_append_cstring(state.output, "Name: ");
             RESETCOLOR;
-            string typeString = laye_ast_node_type_to_string(arg.value);
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(typeString));
+            string typeString = laye_ast_node_type_to_string(state.context, arg.value);
+            string_builder_append_string(state.output, typeString);
             string_deallocate(typeString);
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
     }
 
@@ -368,26 +493,26 @@ static void laye_ast_fprint_struct_variant(ast_fprint_state state, laye_ast_stru
     if (variant.isVoid)
     {
         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-        fprintf(state.stream, " <");
+        string_builder_append_cstring(state.output, " <");
         PUTCOLOR(ANSI_COLOR_BLUE);
-        fprintf(state.stream, "Void");
+        string_builder_append_cstring(state.output, "Void");
         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-        fprintf(state.stream, ">");
+        string_builder_append_cstring(state.output, ">");
     }
     else
     {
         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-        fprintf(state.stream, " <");
+        string_builder_append_cstring(state.output, " <");
         PUTCOLOR(ANSI_COLOR_BLUE);
-        fprintf(state.stream, "Name: ");
+        string_builder_append_cstring(state.output, "Name: ");
         RESETCOLOR;
-        fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(variant.name));
+        string_builder_append_string(state.output, layec_symbol_name(state.context, variant.name));
         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-        fprintf(state.stream, ">");
+        string_builder_append_cstring(state.output, ">");
     }
 
     RESETCOLOR;
-    fprintf(state.stream, "\n");
+    string_builder_append_cstring(state.output, "\n");
 
     usize lastStringBuilderCount = state.indents->count;
     string_builder_append_cstring(state.indents, isLast ? "  " : "│ ");
@@ -404,16 +529,16 @@ static void laye_ast_fprint_enum_variant(ast_fprint_state state, laye_ast_enum_v
     laye_ast_fprint_name(state, STRING_VIEW_LITERAL("ENUM_VARIANT"), isLast);
 
     PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-    fprintf(state.stream, " <");
+    string_builder_append_cstring(state.output, " <");
     PUTCOLOR(ANSI_COLOR_BLUE);
-    fprintf(state.stream, "Name: ");
+    string_builder_append_cstring(state.output, "Name: ");
     RESETCOLOR;
-    fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(variant.name));
+    string_builder_append_string(state.output, layec_symbol_name(state.context, variant.name));
     PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-    fprintf(state.stream, ">");
+    string_builder_append_cstring(state.output, ">");
 
     RESETCOLOR;
-    fprintf(state.stream, "\n");
+    string_builder_append_cstring(state.output, "\n");
     
     if (variant.value != nullptr)
     {
@@ -429,16 +554,16 @@ static void laye_ast_fprint_constructor_value(ast_fprint_state state, laye_ast_c
     laye_ast_fprint_name(state, STRING_VIEW_LITERAL("FIELD_ASSIGN"), isLast);
 
     PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-    fprintf(state.stream, " <");
+    string_builder_append_cstring(state.output, " <");
     PUTCOLOR(ANSI_COLOR_BLUE);
-    fprintf(state.stream, "Name: ");
+    string_builder_append_cstring(state.output, "Name: ");
     RESETCOLOR;
-    fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(value.name));
+    string_builder_append_string(state.output, layec_symbol_name(state.context, value.name));
     PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-    fprintf(state.stream, ">");
+    string_builder_append_cstring(state.output, ">");
 
     RESETCOLOR;
-    fprintf(state.stream, "\n");
+    string_builder_append_cstring(state.output, "\n");
     
     usize lastStringBuilderCount = state.indents->count;
     string_builder_append_cstring(state.indents, isLast ? "  " : "│ ");
@@ -457,89 +582,92 @@ static void laye_ast_fprint_node(ast_fprint_state state, laye_ast_node* node, bo
         case LAYE_AST_NODE_BINDING_DECLARATION:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Name: ");
+            string_builder_append_cstring(state.output, "Name: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->functionDeclaration.name));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, node->bindingDeclaration.name));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, "> <");
+            string_builder_append_cstring(state.output, "> <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Type: ");
+            string_builder_append_cstring(state.output, "Type: ");
             RESETCOLOR;
             
-            string typeString = laye_ast_node_type_to_string(node->functionDeclaration.returnType);
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(typeString));
+            string typeString = laye_ast_node_type_to_string(state.context, node->bindingDeclaration.declaredType);
+            string_builder_append_string(state.output, typeString);
             string_deallocate(typeString);
 
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_STRUCT_DECLARATION:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Name: ");
+            string_builder_append_cstring(state.output, "Name: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->structDeclaration.name));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, node->structDeclaration.name));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_ENUM_DECLARATION:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Name: ");
+            string_builder_append_cstring(state.output, "Name: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->enumDeclaration.name));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, node->enumDeclaration.name));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_FUNCTION_DECLARATION:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Name: ");
+            string_builder_append_cstring(state.output, "Name: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->functionDeclaration.name));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, node->functionDeclaration.name));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, "> <");
+            string_builder_append_cstring(state.output, "> <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Type: ");
+            string_builder_append_cstring(state.output, "Type: ");
             RESETCOLOR;
 
-            string returnTypeString = laye_ast_node_type_to_string(node->functionDeclaration.returnType);
-            fprintf(state.stream, STRING_FORMAT"(", STRING_EXPAND(returnTypeString));
+            string returnTypeString = laye_ast_node_type_to_string(state.context, node->functionDeclaration.returnType);
+            string_builder_append_string(state.output, returnTypeString);
+            string_builder_append_rune(state.output, '(');
             string_deallocate(returnTypeString);
 
             bool isLayeVarargs = node->functionDeclaration.varargsKind == LAYE_AST_VARARGS_LAYE;
             for (usize i = 0, len = arrlenu(node->functionDeclaration.parameterBindings); i < len; i++)
             {
                 if (i > 0)
-                    fprintf(state.stream, ", ");
+                    string_builder_append_cstring(state.output, ", ");
 
                 if (i == len - 1 && isLayeVarargs)
-                    fprintf(state.stream, "varargs ");
+                    string_builder_append_cstring(state.output, "varargs ");
 
                 laye_ast_node* parameterBinding = node->functionDeclaration.parameterBindings[i];
 
-                string paramTypeString = laye_ast_node_type_to_string(parameterBinding->bindingDeclaration.declaredType);
-                fprintf(state.stream, STRING_FORMAT" "STRING_FORMAT, STRING_EXPAND(paramTypeString), STRING_EXPAND(parameterBinding->bindingDeclaration.name));
+                string paramTypeString = laye_ast_node_type_to_string(state.context, parameterBinding->bindingDeclaration.declaredType);
+                string_builder_append_string(state.output, paramTypeString);
+                string_builder_append_rune(state.output, ' ');
+                string_builder_append_string(state.output, layec_symbol_name(state.context, parameterBinding->bindingDeclaration.name));
                 string_deallocate(paramTypeString);
             }
 
             if (node->functionDeclaration.varargsKind == LAYE_AST_VARARGS_C)
-                fprintf(state.stream, ", varargs");
+                string_builder_append_cstring(state.output, ", varargs");
 
-            fprintf(state.stream, ")");
+            string_builder_append_cstring(state.output, ")");
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
 
             usize modifiersLen = arrlen(node->functionDeclaration.modifiers);
             for (usize i = 0; i < modifiersLen; i++)
@@ -551,37 +679,37 @@ static void laye_ast_fprint_node(ast_fprint_state state, laye_ast_node* node, bo
                     case LAYE_AST_MODIFIER_EXPORT:
                     {
                         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-                        fprintf(state.stream, " <");
+                        string_builder_append_cstring(state.output, " <");
                         PUTCOLOR(ANSI_COLOR_BLUE);
-                        fprintf(state.stream, "Export");
+                        string_builder_append_cstring(state.output, "Export");
                         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-                        fprintf(state.stream, ">");
+                        string_builder_append_cstring(state.output, ">");
                     } break;
                     
                     case LAYE_AST_MODIFIER_INLINE:
                     {
                         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-                        fprintf(state.stream, " <");
+                        string_builder_append_cstring(state.output, " <");
                         PUTCOLOR(ANSI_COLOR_BLUE);
-                        fprintf(state.stream, "Inline");
+                        string_builder_append_cstring(state.output, "Inline");
                         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-                        fprintf(state.stream, ">");
+                        string_builder_append_cstring(state.output, ">");
                     } break;
                     
                     case LAYE_AST_MODIFIER_FOREIGN:
                     {
                         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-                        fprintf(state.stream, " <");
+                        string_builder_append_cstring(state.output, " <");
                         PUTCOLOR(ANSI_COLOR_BLUE);
-                        fprintf(state.stream, "Foreign");
+                        string_builder_append_cstring(state.output, "Foreign");
                         if (modifier.foreignName.count > 0)
                         {
-                            fprintf(state.stream, ": ");
+                            string_builder_append_cstring(state.output, ": ");
                             RESETCOLOR;
-                            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(modifier.foreignName));
+                            string_builder_append_string(state.output, modifier.foreignName);
                         }
                         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-                        fprintf(state.stream, ">");
+                        string_builder_append_cstring(state.output, ">");
                     } break;
                 }
             }
@@ -590,132 +718,134 @@ static void laye_ast_fprint_node(ast_fprint_state state, laye_ast_node* node, bo
         case LAYE_AST_NODE_EXPRESSION_LOOKUP:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Path: ");
+            string_builder_append_cstring(state.output, "Path: ");
             RESETCOLOR;
             if (node->lookup.isHeadless)
-                fprintf(state.stream, "::");
+                string_builder_append_cstring(state.output, "::");
             else if (node->lookup.isGlobal)
-                fprintf(state.stream, "global::");
+                string_builder_append_cstring(state.output, "global::");
             for (usize i = 0, iLen = arrlenu(node->lookup.path); i < iLen; i++)
             {
                 if (i > 0)
-                    fprintf(state.stream, "::");
-                fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->lookup.path[i]));
+                    string_builder_append_cstring(state.output, "::");
+                string_builder_append_string(state.output, layec_symbol_name(state.context, node->lookup.path[i]));
             }
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_STRING:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Value: ");
+            string_builder_append_cstring(state.output, "Value: ");
             RESETCOLOR;
             // TODO(local): it's actually awkward to print newlines, should we do anything about that?
-            fprintf(state.stream, "\""STRING_FORMAT"\"", STRING_EXPAND(node->literal.stringValue));
+            string_builder_append_rune(state.output, '"');
+            string_builder_append_string(state.output, node->literal.stringValue);
+            string_builder_append_rune(state.output, '"');
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_INTEGER:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Value: ");
+            string_builder_append_cstring(state.output, "Value: ");
             RESETCOLOR;
-            fprintf(state.stream, "%llu", cast(unsigned long long int) node->literal.integerValue);
+            string_builder_append_format(state.output, "%llu", cast(unsigned long long int) node->literal.integerValue);
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_BOOL:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Value: ");
+            string_builder_append_cstring(state.output, "Value: ");
             RESETCOLOR;
-            fprintf(state.stream, "%s", node->literal.boolValue ? "true" : "false");
+            string_builder_append_cstring(state.output, node->literal.boolValue ? "true" : "false");
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_BINARY:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Operator: ");
+            string_builder_append_cstring(state.output, "Operator: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->binary.operatorString));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, node->binary.operatorString));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_CONSTRUCTOR:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Type: ");
+            string_builder_append_cstring(state.output, "Type: ");
             RESETCOLOR;
-            string typeString = laye_ast_node_type_to_string(node->constructor.typeName);
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(typeString));
+            string typeString = laye_ast_node_type_to_string(state.context, node->constructor.typeName);
+            string_builder_append_string(state.output, typeString);
             string_deallocate(typeString);
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_NEW:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Type: ");
+            string_builder_append_cstring(state.output, "Type: ");
             RESETCOLOR;
-            string typeString = laye_ast_node_type_to_string(node->new.type);
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(typeString));
+            string typeString = laye_ast_node_type_to_string(state.context, node->new.type);
+            string_builder_append_string(state.output, typeString);
             string_deallocate(typeString);
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_FIELD_INDEX:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Field Name: ");
+            string_builder_append_cstring(state.output, "Field Name: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->field_index.name));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, node->field_index.name));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_CATCH:
         {
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            if (node->catch.captureName.count > 0)
+            if (node->catch.captureName != 0)
             {
-                fprintf(state.stream, "Capture Name: ");
+                string_builder_append_cstring(state.output, "Capture Name: ");
                 RESETCOLOR;
-                fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(node->catch.captureName));
+                string_builder_append_string(state.output, layec_symbol_name(state.context, node->catch.captureName));
             }
-            else fprintf(state.stream, "No Capture");
+            else string_builder_append_cstring(state.output, "No Capture");
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         } break;
     }
 
     RESETCOLOR;
-    fprintf(state.stream, "\n");
+    string_builder_append_cstring(state.output, "\n");
 
     usize lastStringBuilderCount = state.indents->count;
     string_builder_append_cstring(state.indents, isLast ? "  " : "│ ");
@@ -804,7 +934,7 @@ static void laye_ast_fprint_node(ast_fprint_state state, laye_ast_node* node, bo
             laye_ast_fprint_node(state, node->_while.condition, false);
             laye_ast_fprint_node(state, node->_while.body, node->_while.fail == nullptr);
 
-            if (node->_if.fail != nullptr)
+            if (node->_while.fail != nullptr)
                 laye_ast_fprint_node(state, node->_while.fail, true);
         } break;
 
@@ -841,7 +971,7 @@ static void laye_ast_fprint_node(ast_fprint_state state, laye_ast_node* node, bo
 
         case LAYE_AST_NODE_EXPRESSION_FIELD_INDEX:
         {
-            laye_ast_fprint_node(state, node->container_index.target, true);
+            laye_ast_fprint_node(state, node->field_index.target, true);
         } break;
 
         case LAYE_AST_NODE_EXPRESSION_BINARY:
@@ -883,24 +1013,29 @@ static void laye_ast_fprint_node(ast_fprint_state state, laye_ast_node* node, bo
 
 void laye_ast_fprint(FILE* stream, layec_context* context, laye_ast* ast, bool colors)
 {
-    string_builder sb = { 0 };
-    string_builder_init(&sb, default_allocator);
+    string_builder indents = { 0 };
+    string_builder_init(&indents, default_allocator);
+    string_builder output = { 0 };
+    string_builder_init(&output, default_allocator);
 
     ast_fprint_state state = {
         .stream = stream,
+        .context = context,
         .ast = ast,
         .colors = colors,
-        .indents = &sb,
+        .indents = &indents,
+        .output = &output,
     };
 
     string_view filePath = layec_context_get_file_full_path(context, ast->fileId);
 
     PUTCOLOR(ANSI_COLOR_RED);
-    fprintf(stream, "ROOT");
+    string_builder_append_cstring(state.output, "ROOT");
     PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-    fprintf(stream, " "STRING_VIEW_FORMAT, STRING_VIEW_EXPAND(filePath));
+    string_builder_append_rune(state.output, ' ');
+    string_builder_append_view(state.output, filePath);
     RESETCOLOR;
-    fprintf(stream, "\n");
+    string_builder_append_cstring(state.output, "\n");
 
     usize importCount = arrlenu(ast->imports);
     usize topLevelNodeCount = arrlenu(ast->topLevelNodes);
@@ -911,61 +1046,61 @@ void laye_ast_fprint(FILE* stream, layec_context* context, laye_ast* ast, bool c
         bool isLast = i == importCount - 1 && topLevelNodeCount == 0;
         laye_ast_fprint_name(state, STRING_VIEW_LITERAL("IMPORT"), isLast);
         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-        fprintf(state.stream, " <");
+        string_builder_append_cstring(state.output, " <");
         PUTCOLOR(ANSI_COLOR_BLUE);
-        fprintf(state.stream, "Name: ");
+        string_builder_append_cstring(state.output, "Name: ");
         RESETCOLOR;
-        fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(import.name));
+        string_builder_append_string(state.output, layec_symbol_name(state.context, import.name));
         PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-        fprintf(state.stream, ">");
+        string_builder_append_cstring(state.output, ">");
         
-        if (import.alias.count > 0)
+        if (import.alias != 0)
         {
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Alias: ");
+            string_builder_append_cstring(state.output, "Alias: ");
             RESETCOLOR;
-            fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(import.alias));
+            string_builder_append_string(state.output, layec_symbol_name(state.context, import.alias));
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         }
         
         if (import.export)
         {
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Export");
+            string_builder_append_cstring(state.output, "Export");
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         }
 
         if (import.allMembers)
         {
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Captures All");
+            string_builder_append_cstring(state.output, "Captures All");
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         }
         else if (arrlenu(import.explicitMembers) > 0)
         {
-            fprintf(state.stream, " <");
+            string_builder_append_cstring(state.output, " <");
             PUTCOLOR(ANSI_COLOR_BLUE);
-            fprintf(state.stream, "Captures: ");
+            string_builder_append_cstring(state.output, "Captures: ");
             RESETCOLOR;
             for (usize j = 0, jLen = arrlenu(import.explicitMembers); j < jLen; j++)
             {
                 if (j > 0)
-                    fprintf(state.stream, ", ");
-                string memberName = import.explicitMembers[i];
-                fprintf(state.stream, STRING_FORMAT, STRING_EXPAND(memberName));
+                    string_builder_append_cstring(state.output, ", ");
+                layec_symbol memberName = import.explicitMembers[j];
+                string_builder_append_string(state.output, layec_symbol_name(state.context, memberName));
             }
             PUTCOLOR(ANSI_COLOR_BRIGHT_BLACK);
-            fprintf(state.stream, ">");
+            string_builder_append_cstring(state.output, ">");
         }
 
         RESETCOLOR;
-        fprintf(state.stream, "\n");
+        string_builder_append_cstring(state.output, "\n");
     }
 
     for (usize i = 0; i < topLevelNodeCount; i++)
@@ -973,5 +1108,466 @@ void laye_ast_fprint(FILE* stream, layec_context* context, laye_ast* ast, bool c
         laye_ast_fprint_node(state, ast->topLevelNodes[i], i == topLevelNodeCount - 1);
     }
 
-    string_builder_deallocate(state.indents);
+    laye_ast_fprint_flush(state);
+    string_builder_deallocate(&indents);
+    string_builder_deallocate(&output);
+}
+
+static void laye_ast_fprint_json_name(ast_fprint_state state, layec_symbol symbol)
+{
+    string name = layec_symbol_name(state.context, symbol);
+    layec_append_json_string(state.output, string_slice(name, 0, name.count));
+}
+
+// members are always added after an object's kind, so each one starts with a comma.
+static void laye_ast_fprint_json_symbol(ast_fprint_state state, const char* key, layec_symbol symbol)
+{
+    string_builder_append_format(state.output, ",\"%s\":", key);
+    laye_ast_fprint_json_name(state, symbol);
+}
+
+static void laye_ast_fprint_json_type(ast_fprint_state state, const char* key, laye_ast_node* typeNode)
+{
+    string_builder_append_format(state.output, ",\"%s\":", key);
+    string typeString = laye_ast_node_type_to_string(state.context, typeNode);
+    layec_append_json_string(state.output, string_slice(typeString, 0, typeString.count));
+    string_deallocate(typeString);
+}
+
+// starts an object with its kind, and where it is in its file if it has a location.
+static void laye_ast_fprint_json_begin(ast_fprint_state state, string_view kind, layec_location location)
+{
+    if (state.output->count >= AST_FPRINT_FLUSH_SIZE)
+        laye_ast_fprint_flush(state);
+
+    string_builder_append_cstring(state.output, "{\"kind\":\"");
+    string_builder_append_view(state.output, kind);
+    string_builder_append_rune(state.output, '"');
+
+    usize fileOffset = 0;
+    if (layec_context_decode_location(state.context, location, &fileOffset) != 0)
+        string_builder_append_format(state.output, ",\"offset\":%zu,\"length\":%u", fileOffset, location.length);
+}
+
+// starts the children of an object on the first one, `childCount` is how many the object has so far.
+static void laye_ast_fprint_json_child(ast_fprint_state state, usize* childCount)
+{
+    string_builder_append_cstring(state.output, *childCount == 0 ? ",\"children\":[" : ",");
+    (*childCount)++;
+}
+
+static void laye_ast_fprint_json_end(ast_fprint_state state, usize childCount)
+{
+    string_builder_append_cstring(state.output, childCount == 0 ? "}" : "]}");
+}
+
+static void laye_ast_fprint_json_node(ast_fprint_state state, laye_ast_node* node);
+
+static void laye_ast_fprint_json_child_node(ast_fprint_state state, laye_ast_node* node, usize* childCount)
+{
+    if (node == nullptr)
+        return;
+
+    laye_ast_fprint_json_child(state, childCount);
+    laye_ast_fprint_json_node(state, node);
+}
+
+static void laye_ast_fprint_json_template_parameter(ast_fprint_state state, laye_ast_template_parameter param)
+{
+    laye_ast_fprint_json_begin(state, STRING_VIEW_LITERAL("TEMPLATE_PARAMETER"), (layec_location){ 0 });
+    laye_ast_fprint_json_symbol(state, "name", param.name);
+    if (param.kind == LAYE_TEMPLATE_PARAM_VALUE)
+        laye_ast_fprint_json_type(state, "type", param.valueType);
+    laye_ast_fprint_json_end(state, 0);
+}
+
+static void laye_ast_fprint_json_struct_variant(ast_fprint_state state, laye_ast_struct_variant variant)
+{
+    laye_ast_fprint_json_begin(state, STRING_VIEW_LITERAL("STRUCT_VARIANT"), (layec_location){ 0 });
+    if (variant.isVoid)
+        string_builder_append_cstring(state.output, ",\"void\":true");
+    else laye_ast_fprint_json_symbol(state, "name", variant.name);
+
+    usize childCount = 0;
+    for (usize i = 0; i < arrlenu(variant.fieldBindings); i++)
+        laye_ast_fprint_json_child_node(state, variant.fieldBindings[i], &childCount);
+    laye_ast_fprint_json_end(state, childCount);
+}
+
+static void laye_ast_fprint_json_enum_variant(ast_fprint_state state, laye_ast_enum_variant variant)
+{
+    laye_ast_fprint_json_begin(state, STRING_VIEW_LITERAL("ENUM_VARIANT"), (layec_location){ 0 });
+    laye_ast_fprint_json_symbol(state, "name", variant.name);
+
+    usize childCount = 0;
+    laye_ast_fprint_json_child_node(state, variant.value, &childCount);
+    laye_ast_fprint_json_end(state, childCount);
+}
+
+static void laye_ast_fprint_json_constructor_value(ast_fprint_state state, laye_ast_constructor_value value)
+{
+    laye_ast_fprint_json_begin(state, STRING_VIEW_LITERAL("FIELD_ASSIGN"), (layec_location){ 0 });
+    laye_ast_fprint_json_symbol(state, "name", value.name);
+
+    usize childCount = 0;
+    laye_ast_fprint_json_child_node(state, value.value, &childCount);
+    laye_ast_fprint_json_end(state, childCount);
+}
+
+static void laye_ast_fprint_json_node(ast_fprint_state state, laye_ast_node* node)
+{
+    laye_ast_fprint_json_begin(state, laye_ast_node_kind_name(node->kind), node->location);
+
+    switch (node->kind)
+    {
+        default: break;
+
+        case LAYE_AST_NODE_BINDING_DECLARATION:
+        {
+            laye_ast_fprint_json_symbol(state, "name", node->bindingDeclaration.name);
+            laye_ast_fprint_json_type(state, "type", node->bindingDeclaration.declaredType);
+        } break;
+
+        case LAYE_AST_NODE_STRUCT_DECLARATION:
+        {
+            laye_ast_fprint_json_symbol(state, "name", node->structDeclaration.name);
+        } break;
+
+        case LAYE_AST_NODE_ENUM_DECLARATION:
+        {
+            laye_ast_fprint_json_symbol(state, "name", node->enumDeclaration.name);
+        } break;
+
+        case LAYE_AST_NODE_FUNCTION_DECLARATION:
+        {
+            laye_ast_fprint_json_symbol(state, "name", node->functionDeclaration.name);
+            laye_ast_fprint_json_type(state, "returnType", node->functionDeclaration.returnType);
+
+            string_builder_append_cstring(state.output, ",\"parameters\":[");
+            for (usize i = 0, len = arrlenu(node->functionDeclaration.parameterBindings); i < len; i++)
+            {
+                laye_ast_node* parameterBinding = node->functionDeclaration.parameterBindings[i];
+                string_builder_append_cstring(state.output, i > 0 ? ",{\"name\":" : "{\"name\":");
+                laye_ast_fprint_json_name(state, parameterBinding->bindingDeclaration.name);
+                laye_ast_fprint_json_type(state, "type", parameterBinding->bindingDeclaration.declaredType);
+                string_builder_append_rune(state.output, '}');
+            }
+            string_builder_append_rune(state.output, ']');
+
+            if (node->functionDeclaration.varargsKind == LAYE_AST_VARARGS_LAYE)
+                string_builder_append_cstring(state.output, ",\"varargs\":\"laye\"");
+            else if (node->functionDeclaration.varargsKind == LAYE_AST_VARARGS_C)
+                string_builder_append_cstring(state.output, ",\"varargs\":\"c\"");
+
+            string_builder_append_cstring(state.output, ",\"modifiers\":[");
+            usize modifierCount = 0;
+            for (usize i = 0; i < arrlenu(node->functionDeclaration.modifiers); i++)
+            {
+                laye_ast_modifier modifier = node->functionDeclaration.modifiers[i];
+                switch (modifier.kind)
+                {
+                    default: continue;
+                    case LAYE_AST_MODIFIER_EXPORT:
+                    {
+                        string_builder_append_cstring(state.output, modifierCount > 0 ? ",{\"kind\":\"export\"}" : "{\"kind\":\"export\"}");
+                    } break;
+
+                    case LAYE_AST_MODIFIER_INLINE:
+                    {
+                        string_builder_append_cstring(state.output, modifierCount > 0 ? ",{\"kind\":\"inline\"}" : "{\"kind\":\"inline\"}");
+                    } break;
+
+                    case LAYE_AST_MODIFIER_FOREIGN:
+                    {
+                        string_builder_append_cstring(state.output, modifierCount > 0 ? ",{\"kind\":\"foreign\"" : "{\"kind\":\"foreign\"");
+                        if (modifier.foreignName.count > 0)
+                        {
+                            string_builder_append_cstring(state.output, ",\"name\":");
+                            layec_append_json_string(state.output, string_slice(modifier.foreignName, 0, modifier.foreignName.count));
+                        }
+                        string_builder_append_rune(state.output, '}');
+                    } break;
+                }
+
+                modifierCount++;
+            }
+            string_builder_append_rune(state.output, ']');
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_LOOKUP:
+        {
+            if (node->lookup.isHeadless)
+                string_builder_append_cstring(state.output, ",\"headless\":true");
+            else if (node->lookup.isGlobal)
+                string_builder_append_cstring(state.output, ",\"global\":true");
+
+            string_builder_append_cstring(state.output, ",\"path\":[");
+            for (usize i = 0, iLen = arrlenu(node->lookup.path); i < iLen; i++)
+            {
+                if (i > 0)
+                    string_builder_append_rune(state.output, ',');
+                laye_ast_fprint_json_name(state, node->lookup.path[i]);
+            }
+            string_builder_append_rune(state.output, ']');
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_STRING:
+        {
+            string_builder_append_cstring(state.output, ",\"value\":");
+            layec_append_json_string(state.output, string_slice(node->literal.stringValue, 0, node->literal.stringValue.count));
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INTEGER:
+        {
+            string_builder_append_format(state.output, ",\"value\":%llu", cast(unsigned long long int) node->literal.integerValue);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_BOOL:
+        {
+            string_builder_append_cstring(state.output, node->literal.boolValue ? ",\"value\":true" : ",\"value\":false");
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_BINARY:
+        {
+            laye_ast_fprint_json_symbol(state, "operator", node->binary.operatorString);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CONSTRUCTOR:
+        {
+            laye_ast_fprint_json_type(state, "type", node->constructor.typeName);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_NEW:
+        {
+            laye_ast_fprint_json_type(state, "type", node->new.type);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_FIELD_INDEX:
+        {
+            laye_ast_fprint_json_symbol(state, "fieldName", node->field_index.name);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CATCH:
+        {
+            if (node->catch.captureName != 0)
+                laye_ast_fprint_json_symbol(state, "captureName", node->catch.captureName);
+        } break;
+    }
+
+    usize childCount = 0;
+    switch (node->kind)
+    {
+        default: break;
+
+        case LAYE_AST_NODE_FUNCTION_DECLARATION:
+        {
+            for (usize i = 0; i < arrlenu(node->functionDeclaration.templateParameters); i++)
+            {
+                laye_ast_fprint_json_child(state, &childCount);
+                laye_ast_fprint_json_template_parameter(state, node->functionDeclaration.templateParameters[i]);
+            }
+
+            laye_ast_fprint_json_child_node(state, node->functionDeclaration.body, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_STRUCT_DECLARATION:
+        {
+            for (usize i = 0; i < arrlenu(node->structDeclaration.templateParameters); i++)
+            {
+                laye_ast_fprint_json_child(state, &childCount);
+                laye_ast_fprint_json_template_parameter(state, node->structDeclaration.templateParameters[i]);
+            }
+
+            for (usize i = 0; i < arrlenu(node->structDeclaration.fieldBindings); i++)
+                laye_ast_fprint_json_child_node(state, node->structDeclaration.fieldBindings[i], &childCount);
+
+            for (usize i = 0; i < arrlenu(node->structDeclaration.variants); i++)
+            {
+                laye_ast_fprint_json_child(state, &childCount);
+                laye_ast_fprint_json_struct_variant(state, node->structDeclaration.variants[i]);
+            }
+        } break;
+
+        case LAYE_AST_NODE_ENUM_DECLARATION:
+        {
+            for (usize i = 0; i < arrlenu(node->enumDeclaration.variants); i++)
+            {
+                laye_ast_fprint_json_child(state, &childCount);
+                laye_ast_fprint_json_enum_variant(state, node->enumDeclaration.variants[i]);
+            }
+        } break;
+
+        case LAYE_AST_NODE_BINDING_DECLARATION:
+        {
+            laye_ast_fprint_json_child_node(state, node->bindingDeclaration.initialValue, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_BLOCK:
+        {
+            for (usize i = 0; i < arrlenu(node->statements); i++)
+                laye_ast_fprint_json_child_node(state, node->statements[i], &childCount);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_ASSIGNMENT:
+        {
+            laye_ast_fprint_json_child_node(state, node->assignment.target, &childCount);
+            laye_ast_fprint_json_child_node(state, node->assignment.value, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_RETURN:
+        case LAYE_AST_NODE_STATEMENT_YIELD:
+        case LAYE_AST_NODE_STATEMENT_YIELD_RETURN:
+        {
+            laye_ast_fprint_json_child_node(state, node->returnValue, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_IF:
+        {
+            for (usize i = 0; i < arrlenu(node->_if.conditionals); i++)
+            {
+                laye_ast_fprint_json_child_node(state, node->_if.conditionals[i].condition, &childCount);
+                laye_ast_fprint_json_child_node(state, node->_if.conditionals[i].body, &childCount);
+            }
+
+            laye_ast_fprint_json_child_node(state, node->_if.fail, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_WHILE:
+        {
+            laye_ast_fprint_json_child_node(state, node->_while.condition, &childCount);
+            laye_ast_fprint_json_child_node(state, node->_while.body, &childCount);
+            laye_ast_fprint_json_child_node(state, node->_while.fail, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_DO_WHILE:
+        {
+            laye_ast_fprint_json_child_node(state, node->_while.body, &childCount);
+            laye_ast_fprint_json_child_node(state, node->_while.condition, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INVOKE:
+        {
+            laye_ast_fprint_json_child_node(state, node->invoke.target, &childCount);
+            for (usize i = 0; i < arrlenu(node->invoke.arguments); i++)
+                laye_ast_fprint_json_child_node(state, node->invoke.arguments[i], &childCount);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_SLICE:
+        {
+            laye_ast_fprint_json_child_node(state, node->slice.target, &childCount);
+            laye_ast_fprint_json_child_node(state, node->slice.offset, &childCount);
+            laye_ast_fprint_json_child_node(state, node->slice.length, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INDEX:
+        {
+            laye_ast_fprint_json_child_node(state, node->container_index.target, &childCount);
+            for (usize i = 0; i < arrlenu(node->container_index.arguments); i++)
+                laye_ast_fprint_json_child_node(state, node->container_index.arguments[i], &childCount);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_FIELD_INDEX:
+        {
+            laye_ast_fprint_json_child_node(state, node->field_index.target, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_BINARY:
+        {
+            laye_ast_fprint_json_child_node(state, node->binary.lhs, &childCount);
+            laye_ast_fprint_json_child_node(state, node->binary.rhs, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CONSTRUCTOR:
+        {
+            for (usize i = 0; i < arrlenu(node->constructor.values); i++)
+            {
+                laye_ast_fprint_json_child(state, &childCount);
+                laye_ast_fprint_json_constructor_value(state, node->constructor.values[i]);
+            }
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_NEW:
+        {
+            laye_ast_fprint_json_child_node(state, node->new.allocator, &childCount);
+            for (usize i = 0; i < arrlenu(node->new.values); i++)
+            {
+                laye_ast_fprint_json_child(state, &childCount);
+                laye_ast_fprint_json_constructor_value(state, node->new.values[i]);
+            }
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_TRY:
+        {
+            laye_ast_fprint_json_child_node(state, node->try.target, &childCount);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CATCH:
+        {
+            laye_ast_fprint_json_child_node(state, node->catch.target, &childCount);
+            laye_ast_fprint_json_child_node(state, node->catch.body, &childCount);
+        } break;
+    }
+
+    laye_ast_fprint_json_end(state, childCount);
+}
+
+void laye_ast_fprint_json(FILE* stream, layec_context* context, laye_ast* ast)
+{
+    string_builder output = { 0 };
+    string_builder_init(&output, default_allocator);
+
+    ast_fprint_state state = {
+        .stream = stream,
+        .context = context,
+        .ast = ast,
+        .output = &output,
+    };
+
+    // each file is one object on its own line, like the JSON diagnostics.
+    string_builder_append_cstring(state.output, "{\"kind\":\"ROOT\",\"file\":");
+    layec_append_json_string(state.output, layec_context_get_file_full_path(context, ast->fileId));
+
+    string_builder_append_cstring(state.output, ",\"imports\":[");
+    for (usize i = 0; i < arrlenu(ast->imports); i++)
+    {
+        laye_ast_import import = ast->imports[i];
+        if (i > 0)
+            string_builder_append_rune(state.output, ',');
+
+        laye_ast_fprint_json_begin(state, STRING_VIEW_LITERAL("IMPORT"), import.location);
+        laye_ast_fprint_json_symbol(state, "name", import.name);
+        if (import.alias != 0)
+            laye_ast_fprint_json_symbol(state, "alias", import.alias);
+        if (import.export)
+            string_builder_append_cstring(state.output, ",\"export\":true");
+
+        if (import.allMembers)
+            string_builder_append_cstring(state.output, ",\"allMembers\":true");
+        else if (arrlenu(import.explicitMembers) > 0)
+        {
+            string_builder_append_cstring(state.output, ",\"members\":[");
+            for (usize j = 0; j < arrlenu(import.explicitMembers); j++)
+            {
+                if (j > 0)
+                    string_builder_append_rune(state.output, ',');
+                laye_ast_fprint_json_name(state, import.explicitMembers[j]);
+            }
+            string_builder_append_rune(state.output, ']');
+        }
+
+        laye_ast_fprint_json_end(state, 0);
+    }
+
+    string_builder_append_cstring(state.output, "],\"declarations\":[");
+    for (usize i = 0; i < arrlenu(ast->topLevelNodes); i++)
+    {
+        if (i > 0)
+            string_builder_append_rune(state.output, ',');
+        laye_ast_fprint_json_node(state, ast->topLevelNodes[i]);
+    }
+
+    string_builder_append_cstring(state.output, "]}\n");
+
+    laye_ast_fprint_flush(state);
+    string_builder_deallocate(&output);
 }
@@ -0,0 +1,1153 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "kos/kos.h"
+#include "kos/platform.h"
+
+#include "ast.h"
+#include "parser.h"
+
+// a cached tree is a header, then the table of every name the tree uses, its imports and its top level nodes.
+// the header ends with the hash of everything after it, so a damaged cache is never mistaken for a different tree.
+// every integer is an unsigned LEB128 varint, so the encoding is independent of pointer size and struct layout.
+// names are indices into the table and locations are relative to the start of the file, so a cached tree
+// can be loaded into any context, whatever symbols and base offset the file has there.
+// bump the version whenever the encoding, or the order of the node or token kinds, changes.
+#define LAYE_AST_CACHE_VERSION 1
+
+static const uchar astCacheMagic[8] = { 'L', 'A', 'Y', 'E', 'A', 'S', 'T', 0 };
+
+enum
+{
+#define A(E) + 1
+#define T(E) + 1
+    LAYE_AST_NODE_KIND_COUNT = 1 LAYE_AST_NODE_KINDS,
+#undef T
+#undef A
+};
+
+typedef struct ast_cache_writer
+{
+    layec_context* context;
+    u32 baseOffset;
+    string_builder* output;
+    // maps every symbol written to its index in the string table, which lists them in the order they're first written.
+    // index 0 is always the empty name.
+    hashmap(layec_symbol, u32) symbolIndices;
+    list(layec_symbol) symbols;
+    // false once a node is found which the encoding doesn't cover.
+    bool isValid;
+} ast_cache_writer;
+
+static void ast_cache_write_uint(ast_cache_writer* w, u64 value)
+{
+    uchar bytes[10];
+    usize byteCount = 0;
+
+    do
+    {
+        uchar byte = cast(uchar) (value & 0x7F);
+        value >>= 7;
+        bytes[byteCount++] = value != 0 ? cast(uchar) (byte | 0x80) : byte;
+    } while (value != 0);
+
+    string_view encoded = { .memory = bytes, .count = byteCount };
+    string_builder_append_view(w->output, encoded);
+}
+
+static void ast_cache_write_bool(ast_cache_writer* w, bool value)
+{
+    ast_cache_write_uint(w, value ? 1 : 0);
+}
+
+static void ast_cache_write_symbol(ast_cache_writer* w, layec_symbol symbol)
+{
+    if (symbol == 0)
+    {
+        ast_cache_write_uint(w, 0);
+        return;
+    }
+
+    u32 index = hmget(w->symbolIndices, symbol);
+    if (index == 0)
+    {
+        index = cast(u32) arrlenu(w->symbols) + 1;
+        hmput(w->symbolIndices, symbol, index);
+        arrput(w->symbols, symbol);
+    }
+
+    ast_cache_write_uint(w, index);
+}
+
+static void ast_cache_write_location(ast_cache_writer* w, layec_location location)
+{
+    // 0 stays the empty location, every other offset is stored one past its offset in the file.
+    ast_cache_write_uint(w, location.offset == 0 ? 0 : location.offset - w->baseOffset + 1);
+    ast_cache_write_uint(w, location.length);
+}
+
+static void ast_cache_write_string(ast_cache_writer* w, string value)
+{
+    ast_cache_write_uint(w, value.count);
+    string_builder_append_string(w->output, value);
+}
+
+static void ast_cache_write_node(ast_cache_writer* w, laye_ast_node* node);
+
+static void ast_cache_write_node_list(ast_cache_writer* w, list(laye_ast_node*) nodes)
+{
+    ast_cache_write_uint(w, arrlenu(nodes));
+    for (usize i = 0; i < arrlenu(nodes); i++)
+        ast_cache_write_node(w, nodes[i]);
+}
+
+static void ast_cache_write_symbol_list(ast_cache_writer* w, list(layec_symbol) symbols)
+{
+    ast_cache_write_uint(w, arrlenu(symbols));
+    for (usize i = 0; i < arrlenu(symbols); i++)
+        ast_cache_write_symbol(w, symbols[i]);
+}
+
+static void ast_cache_write_modifiers(ast_cache_writer* w, list(laye_ast_modifier) modifiers)
+{
+    ast_cache_write_uint(w, arrlenu(modifiers));
+    for (usize i = 0; i < arrlenu(modifiers); i++)
+    {
+        laye_ast_modifier modifier = modifiers[i];
+        ast_cache_write_uint(w, cast(u64) modifier.kind);
+        ast_cache_write_location(w, modifier.location);
+
+        if (modifier.kind == LAYE_AST_MODIFIER_FOREIGN)
+            ast_cache_write_string(w, modifier.foreignName);
+        else if (modifier.kind == LAYE_AST_MODIFIER_CALLCONV)
+            ast_cache_write_node(w, modifier.callingConventionKind);
+    }
+}
+
+static void ast_cache_write_template_parameters(ast_cache_writer* w, list(laye_ast_template_parameter) parameters)
+{
+    ast_cache_write_uint(w, arrlenu(parameters));
+    for (usize i = 0; i < arrlenu(parameters); i++)
+    {
+        ast_cache_write_uint(w, cast(u64) parameters[i].kind);
+        ast_cache_write_symbol(w, parameters[i].name);
+        ast_cache_write_node(w, parameters[i].valueType);
+    }
+}
+
+static void ast_cache_write_template_arguments(ast_cache_writer* w, list(laye_ast_template_argument) arguments)
+{
+    ast_cache_write_uint(w, arrlenu(arguments));
+    for (usize i = 0; i < arrlenu(arguments); i++)
+    {
+        ast_cache_write_uint(w, cast(u64) arguments[i].kind);
+        ast_cache_write_node(w, arguments[i].value);
+    }
+}
+
+static void ast_cache_write_constructor_values(ast_cache_writer* w, list(laye_ast_constructor_value) values)
+{
+    ast_cache_write_uint(w, arrlenu(values));
+    for (usize i = 0; i < arrlenu(values); i++)
+    {
+        ast_cache_write_symbol(w, values[i].name);
+        ast_cache_write_node(w, values[i].value);
+    }
+}
+
+static void ast_cache_write_node(ast_cache_writer* w, laye_ast_node* node)
+{
+    // 0 is a missing node, every other node starts with its kind + 1.
+    if (node == nullptr)
+    {
+        ast_cache_write_uint(w, 0);
+        return;
+    }
+
+    ast_cache_write_uint(w, cast(u64) node->kind + 1);
+    ast_cache_write_location(w, node->location);
+
+    switch (node->kind)
+    {
+        // kinds the parser doesn't produce yet have no encoding, a tree with one in it isn't cached.
+        default: w->isValid = false; break;
+
+        case LAYE_AST_NODE_INVALID:
+        case LAYE_AST_NODE_TYPE_INVALID:
+        case LAYE_AST_NODE_STATEMENT_YIELD_BREAK:
+        case LAYE_AST_NODE_EXPRESSION_NIL:
+            break;
+
+        case LAYE_AST_NODE_TYPE_INFER:
+        case LAYE_AST_NODE_TYPE_NORETURN:
+        case LAYE_AST_NODE_TYPE_RAWPTR:
+        case LAYE_AST_NODE_TYPE_VOID:
+        case LAYE_AST_NODE_TYPE_STRING:
+        case LAYE_AST_NODE_TYPE_RUNE:
+        case LAYE_AST_NODE_TYPE_BOOL:
+        case LAYE_AST_NODE_TYPE_BOOL_SIZED:
+        case LAYE_AST_NODE_TYPE_INT:
+        case LAYE_AST_NODE_TYPE_INT_SIZED:
+        case LAYE_AST_NODE_TYPE_UINT:
+        case LAYE_AST_NODE_TYPE_UINT_SIZED:
+        case LAYE_AST_NODE_TYPE_FLOAT:
+        case LAYE_AST_NODE_TYPE_FLOAT_SIZED:
+        case LAYE_AST_NODE_TYPE_C_CHAR:
+        case LAYE_AST_NODE_TYPE_C_SCHAR:
+        case LAYE_AST_NODE_TYPE_C_UCHAR:
+        case LAYE_AST_NODE_TYPE_C_STRING:
+        case LAYE_AST_NODE_TYPE_C_SHORT:
+        case LAYE_AST_NODE_TYPE_C_USHORT:
+        case LAYE_AST_NODE_TYPE_C_INT:
+        case LAYE_AST_NODE_TYPE_C_UINT:
+        case LAYE_AST_NODE_TYPE_C_LONG:
+        case LAYE_AST_NODE_TYPE_C_ULONG:
+        case LAYE_AST_NODE_TYPE_C_LONGLONG:
+        case LAYE_AST_NODE_TYPE_C_ULONGLONG:
+        case LAYE_AST_NODE_TYPE_C_SIZE_T:
+        case LAYE_AST_NODE_TYPE_C_PTRDIFF_T:
+        case LAYE_AST_NODE_TYPE_C_FLOAT:
+        case LAYE_AST_NODE_TYPE_C_DOUBLE:
+        case LAYE_AST_NODE_TYPE_C_LONGDOUBLE:
+        case LAYE_AST_NODE_TYPE_C_BOOL:
+        {
+            ast_cache_write_uint(w, cast(u64) node->primitiveType.access);
+            // sizes are never negative, they're stored as unsigned like everything else.
+            ast_cache_write_uint(w, cast(u32) node->primitiveType.size);
+            ast_cache_write_bool(w, node->primitiveType.isNilable);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_ARRAY:
+        case LAYE_AST_NODE_TYPE_SLICE:
+        case LAYE_AST_NODE_TYPE_POINTER:
+        case LAYE_AST_NODE_TYPE_BUFFER:
+        {
+            ast_cache_write_uint(w, cast(u64) node->containerType.access);
+            ast_cache_write_node(w, node->containerType.elementType);
+            ast_cache_write_node_list(w, node->containerType.ranks);
+            ast_cache_write_bool(w, node->containerType.isNilable);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_NAMED:
+        {
+            ast_cache_write_symbol_list(w, node->lookupType.path);
+            ast_cache_write_template_arguments(w, node->lookupType.templateArguments);
+            ast_cache_write_bool(w, node->lookupType.isHeadless);
+            ast_cache_write_bool(w, node->lookupType.isGlobal);
+            ast_cache_write_bool(w, node->lookupType.isNilable);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_FUNCTION:
+        {
+            ast_cache_write_node(w, node->functionType.returnType);
+            ast_cache_write_node_list(w, node->functionType.parameterTypes);
+            ast_cache_write_uint(w, cast(u64) node->functionType.varargsKind);
+            ast_cache_write_bool(w, node->functionType.isNilable);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_ERROR:
+        {
+            ast_cache_write_node(w, node->errorUnionType.valueType);
+            ast_cache_write_node(w, node->errorUnionType.errorPath);
+        } break;
+
+        case LAYE_AST_NODE_BINDING_DECLARATION:
+        {
+            ast_cache_write_modifiers(w, node->bindingDeclaration.modifiers);
+            ast_cache_write_node(w, node->bindingDeclaration.declaredType);
+            ast_cache_write_symbol(w, node->bindingDeclaration.name);
+            ast_cache_write_node(w, node->bindingDeclaration.initialValue);
+        } break;
+
+        case LAYE_AST_NODE_FUNCTION_DECLARATION:
+        {
+            ast_cache_write_modifiers(w, node->functionDeclaration.modifiers);
+            ast_cache_write_node(w, node->functionDeclaration.returnType);
+            ast_cache_write_symbol(w, node->functionDeclaration.name);
+            ast_cache_write_bool(w, node->functionDeclaration.isOperator);
+            ast_cache_write_uint(w, cast(u64) node->functionDeclaration.operator);
+            ast_cache_write_template_parameters(w, node->functionDeclaration.templateParameters);
+            ast_cache_write_node_list(w, node->functionDeclaration.parameterBindings);
+            ast_cache_write_uint(w, cast(u64) node->functionDeclaration.varargsKind);
+            ast_cache_write_node(w, node->functionDeclaration.body);
+        } break;
+
+        case LAYE_AST_NODE_STRUCT_DECLARATION:
+        {
+            ast_cache_write_modifiers(w, node->structDeclaration.modifiers);
+            ast_cache_write_symbol(w, node->structDeclaration.name);
+            ast_cache_write_template_parameters(w, node->structDeclaration.templateParameters);
+            ast_cache_write_node_list(w, node->structDeclaration.fieldBindings);
+
+            ast_cache_write_uint(w, arrlenu(node->structDeclaration.variants));
+            for (usize i = 0; i < arrlenu(node->structDeclaration.variants); i++)
+            {
+                laye_ast_struct_variant variant = node->structDeclaration.variants[i];
+                ast_cache_write_symbol(w, variant.name);
+                ast_cache_write_node_list(w, variant.fieldBindings);
+                ast_cache_write_bool(w, variant.isVoid);
+            }
+        } break;
+
+        case LAYE_AST_NODE_ENUM_DECLARATION:
+        {
+            ast_cache_write_modifiers(w, node->enumDeclaration.modifiers);
+            ast_cache_write_symbol(w, node->enumDeclaration.name);
+            ast_cache_write_template_parameters(w, node->enumDeclaration.templateParameters);
+
+            ast_cache_write_uint(w, arrlenu(node->enumDeclaration.variants));
+            for (usize i = 0; i < arrlenu(node->enumDeclaration.variants); i++)
+            {
+                ast_cache_write_symbol(w, node->enumDeclaration.variants[i].name);
+                ast_cache_write_node(w, node->enumDeclaration.variants[i].value);
+            }
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_BLOCK:
+        {
+            ast_cache_write_node_list(w, node->statements);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_ASSIGNMENT:
+        {
+            ast_cache_write_node(w, node->assignment.target);
+            ast_cache_write_node(w, node->assignment.value);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_IF:
+        {
+            ast_cache_write_uint(w, arrlenu(node->_if.conditionals));
+            for (usize i = 0; i < arrlenu(node->_if.conditionals); i++)
+            {
+                ast_cache_write_node(w, node->_if.conditionals[i].condition);
+                ast_cache_write_node(w, node->_if.conditionals[i].body);
+            }
+
+            ast_cache_write_node(w, node->_if.fail);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_BREAK:
+        {
+            ast_cache_write_symbol(w, node->_break.target);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_CONTINUE:
+        {
+            ast_cache_write_symbol(w, node->_continue.target);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_WHILE:
+        case LAYE_AST_NODE_STATEMENT_DO_WHILE:
+        {
+            ast_cache_write_node(w, node->_while.condition);
+            ast_cache_write_node(w, node->_while.body);
+            ast_cache_write_node(w, node->_while.fail);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_RETURN:
+        case LAYE_AST_NODE_STATEMENT_YIELD:
+        case LAYE_AST_NODE_STATEMENT_YIELD_RETURN:
+        {
+            ast_cache_write_node(w, node->returnValue);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_LOOKUP:
+        {
+            ast_cache_write_symbol_list(w, node->lookup.path);
+            ast_cache_write_template_arguments(w, node->lookup.templateArguments);
+            ast_cache_write_bool(w, node->lookup.isHeadless);
+            ast_cache_write_bool(w, node->lookup.isGlobal);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_BOOL:
+        {
+            ast_cache_write_bool(w, node->literal.boolValue);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_STRING:
+        {
+            ast_cache_write_string(w, node->literal.stringValue);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INTEGER:
+        {
+            ast_cache_write_uint(w, node->literal.integerValue);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_BINARY:
+        {
+            ast_cache_write_node(w, node->binary.lhs);
+            ast_cache_write_node(w, node->binary.rhs);
+            ast_cache_write_uint(w, cast(u64) node->binary.operatorKind);
+            ast_cache_write_symbol(w, node->binary.operatorString);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INVOKE:
+        {
+            ast_cache_write_node(w, node->invoke.target);
+            ast_cache_write_node_list(w, node->invoke.arguments);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_TRY:
+        {
+            ast_cache_write_node(w, node->try.target);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CATCH:
+        {
+            ast_cache_write_node(w, node->catch.target);
+            ast_cache_write_symbol(w, node->catch.captureName);
+            ast_cache_write_node(w, node->catch.body);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CONSTRUCTOR:
+        {
+            ast_cache_write_node(w, node->constructor.typeName);
+            ast_cache_write_constructor_values(w, node->constructor.values);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_SLICE:
+        {
+            ast_cache_write_node(w, node->slice.target);
+            ast_cache_write_node(w, node->slice.offset);
+            ast_cache_write_node(w, node->slice.length);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INDEX:
+        {
+            ast_cache_write_node(w, node->container_index.target);
+            ast_cache_write_node_list(w, node->container_index.arguments);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_FIELD_INDEX:
+        {
+            ast_cache_write_node(w, node->field_index.target);
+            ast_cache_write_symbol(w, node->field_index.name);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_NEW:
+        {
+            ast_cache_write_node(w, node->new.allocator);
+            ast_cache_write_node(w, node->new.type);
+            ast_cache_write_constructor_values(w, node->new.values);
+        } break;
+    }
+}
+
+typedef struct ast_cache_reader
+{
+    layec_context* context;
+    u32 baseOffset;
+    usize sourceLength;
+    arena_allocator* astArena;
+    arena_allocator* constantArena;
+    const uchar* memory;
+    usize count;
+    usize position;
+    // the symbol of every entry in the string table, by index.
+    list(layec_symbol) symbols;
+    // false once the cache is found to be malformed, every read after that returns zeroes.
+    bool isValid;
+} ast_cache_reader;
+
+static u64 ast_cache_read_uint(ast_cache_reader* r)
+{
+    u64 value = 0;
+    for (u32 shift = 0; r->isValid; shift += 7)
+    {
+        if (r->position >= r->count || shift > 63)
+            break;
+
+        uchar byte = r->memory[r->position++];
+        value |= cast(u64) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+
+    r->isValid = false;
+    return 0;
+}
+
+// reads the number of elements in a list, every element takes at least a byte so there can't be more than are left.
+static usize ast_cache_read_count(ast_cache_reader* r)
+{
+    u64 count = ast_cache_read_uint(r);
+    if (count > r->count - r->position)
+    {
+        r->isValid = false;
+        return 0;
+    }
+
+    return cast(usize) count;
+}
+
+static bool ast_cache_read_bool(ast_cache_reader* r)
+{
+    return ast_cache_read_uint(r) != 0;
+}
+
+static layec_symbol ast_cache_read_symbol(ast_cache_reader* r)
+{
+    u64 index = ast_cache_read_uint(r);
+    if (index == 0)
+        return 0;
+
+    if (index > arrlenu(r->symbols))
+    {
+        r->isValid = false;
+        return 0;
+    }
+
+    return r->symbols[index - 1];
+}
+
+static layec_location ast_cache_read_location(ast_cache_reader* r)
+{
+    u64 offset = ast_cache_read_uint(r);
+    u64 length = ast_cache_read_uint(r);
+
+    // every location is within its file, with room for the one past its end.
+    if (offset > r->sourceLength + 1 || length > r->sourceLength + 1 - (offset == 0 ? 0 : offset - 1))
+    {
+        r->isValid = false;
+        return (layec_location){ 0 };
+    }
+
+    return (layec_location){
+        .offset = offset == 0 ? 0 : r->baseOffset + cast(u32) (offset - 1),
+        .length = cast(u32) length,
+    };
+}
+
+static string ast_cache_read_string(ast_cache_reader* r)
+{
+    usize count = ast_cache_read_count(r);
+    if (!r->isValid)
+        return (string){ 0 };
+
+    // strings are allocated where the lexer would have put them.
+    uchar* memory = arena_push_uninit(r->constantArena, count + 1, 1);
+    memcpy(memory, r->memory + r->position, count);
+    memory[count] = 0;
+    r->position += count;
+
+    return (string){ .memory = memory, .count = count };
+}
+
+static laye_ast_node* ast_cache_read_node(ast_cache_reader* r);
+
+static list(laye_ast_node*) ast_cache_read_node_list(ast_cache_reader* r)
+{
+    list(laye_ast_node*) nodes = nullptr;
+    usize count = ast_cache_read_count(r);
+    if (count > 0)
+        arena_list_init(r->astArena, nodes, count);
+
+    for (usize i = 0; i < count; i++)
+        arrput(nodes, ast_cache_read_node(r));
+
+    return nodes;
+}
+
+static list(layec_symbol) ast_cache_read_symbol_list(ast_cache_reader* r)
+{
+    list(layec_symbol) symbols = nullptr;
+    usize count = ast_cache_read_count(r);
+    if (count > 0)
+        arena_list_init(r->astArena, symbols, count);
+
+    for (usize i = 0; i < count; i++)
+        arrput(symbols, ast_cache_read_symbol(r));
+
+    return symbols;
+}
+
+static list(laye_ast_modifier) ast_cache_read_modifiers(ast_cache_reader* r)
+{
+    list(laye_ast_modifier) modifiers = nullptr;
+    usize count = ast_cache_read_count(r);
+    if (count > 0)
+        arena_list_init(r->astArena, modifiers, count);
+
+    for (usize i = 0; i < count; i++)
+    {
+        laye_ast_modifier modifier = { 0 };
+        modifier.kind = cast(laye_ast_modifier_kind) ast_cache_read_uint(r);
+        modifier.location = ast_cache_read_location(r);
+
+        if (modifier.kind == LAYE_AST_MODIFIER_FOREIGN)
+            modifier.foreignName = ast_cache_read_string(r);
+        else if (modifier.kind == LAYE_AST_MODIFIER_CALLCONV)
+            modifier.callingConventionKind = ast_cache_read_node(r);
+
+        arrput(modifiers, modifier);
+    }
+
+    return modifiers;
+}
+
+static list(laye_ast_template_parameter) ast_cache_read_template_parameters(ast_cache_reader* r)
+{
+    list(laye_ast_template_parameter) parameters = nullptr;
+    usize count = ast_cache_read_count(r);
+    if (count > 0)
+        arena_list_init(r->astArena, parameters, count);
+
+    for (usize i = 0; i < count; i++)
+    {
+        laye_ast_template_parameter parameter = { 0 };
+        parameter.kind = cast(laye_ast_template_parameter_kind) ast_cache_read_uint(r);
+        parameter.name = ast_cache_read_symbol(r);
+        parameter.valueType = ast_cache_read_node(r);
+        arrput(parameters, parameter);
+    }
+
+    return parameters;
+}
+
+static list(laye_ast_template_argument) ast_cache_read_template_arguments(ast_cache_reader* r)
+{
+    list(laye_ast_template_argument) arguments = nullptr;
+    usize count = ast_cache_read_count(r);
+    if (count > 0)
+        arena_list_init(r->astArena, arguments, count);
+
+    for (usize i = 0; i < count; i++)
+    {
+        laye_ast_template_argument argument = { 0 };
+        argument.kind = cast(laye_ast_template_argument_kind) ast_cache_read_uint(r);
+        argument.value = ast_cache_read_node(r);
+        arrput(arguments, argument);
+    }
+
+    return arguments;
+}
+
+static list(laye_ast_constructor_value) ast_cache_read_constructor_values(ast_cache_reader* r)
+{
+    list(laye_ast_constructor_value) values = nullptr;
+    usize count = ast_cache_read_count(r);
+    if (count > 0)
+        arena_list_init(r->astArena, values, count);
+
+    for (usize i = 0; i < count; i++)
+    {
+        laye_ast_constructor_value value = { 0 };
+        value.name = ast_cache_read_symbol(r);
+        value.value = ast_cache_read_node(r);
+        arrput(values, value);
+    }
+
+    return values;
+}
+
+static laye_ast_node* ast_cache_read_node(ast_cache_reader* r)
+{
+    u64 kindPlusOne = ast_cache_read_uint(r);
+    if (kindPlusOne == 0 || !r->isValid)
+        return nullptr;
+
+    if (kindPlusOne >= LAYE_AST_NODE_KIND_COUNT + 1)
+    {
+        r->isValid = false;
+        return nullptr;
+    }
+
+    laye_ast_node_kind kind = cast(laye_ast_node_kind) (kindPlusOne - 1);
+    laye_ast_node* node = arena_push_aligned(r->astArena, laye_ast_node_size(kind), ALIGNOF(laye_ast_node));
+    assert(node != nullptr);
+    node->kind = kind;
+    node->location = ast_cache_read_location(r);
+
+    switch (kind)
+    {
+        default: r->isValid = false; break;
+
+        case LAYE_AST_NODE_INVALID:
+        case LAYE_AST_NODE_TYPE_INVALID:
+        case LAYE_AST_NODE_STATEMENT_YIELD_BREAK:
+        case LAYE_AST_NODE_EXPRESSION_NIL:
+            break;
+
+        case LAYE_AST_NODE_TYPE_INFER:
+        case LAYE_AST_NODE_TYPE_NORETURN:
+        case LAYE_AST_NODE_TYPE_RAWPTR:
+        case LAYE_AST_NODE_TYPE_VOID:
+        case LAYE_AST_NODE_TYPE_STRING:
+        case LAYE_AST_NODE_TYPE_RUNE:
+        case LAYE_AST_NODE_TYPE_BOOL:
+        case LAYE_AST_NODE_TYPE_BOOL_SIZED:
+        case LAYE_AST_NODE_TYPE_INT:
+        case LAYE_AST_NODE_TYPE_INT_SIZED:
+        case LAYE_AST_NODE_TYPE_UINT:
+        case LAYE_AST_NODE_TYPE_UINT_SIZED:
+        case LAYE_AST_NODE_TYPE_FLOAT:
+        case LAYE_AST_NODE_TYPE_FLOAT_SIZED:
+        case LAYE_AST_NODE_TYPE_C_CHAR:
+        case LAYE_AST_NODE_TYPE_C_SCHAR:
+        case LAYE_AST_NODE_TYPE_C_UCHAR:
+        case LAYE_AST_NODE_TYPE_C_STRING:
+        case LAYE_AST_NODE_TYPE_C_SHORT:
+        case LAYE_AST_NODE_TYPE_C_USHORT:
+        case LAYE_AST_NODE_TYPE_C_INT:
+        case LAYE_AST_NODE_TYPE_C_UINT:
+        case LAYE_AST_NODE_TYPE_C_LONG:
+        case LAYE_AST_NODE_TYPE_C_ULONG:
+        case LAYE_AST_NODE_TYPE_C_LONGLONG:
+        case LAYE_AST_NODE_TYPE_C_ULONGLONG:
+        case LAYE_AST_NODE_TYPE_C_SIZE_T:
+        case LAYE_AST_NODE_TYPE_C_PTRDIFF_T:
+        case LAYE_AST_NODE_TYPE_C_FLOAT:
+        case LAYE_AST_NODE_TYPE_C_DOUBLE:
+        case LAYE_AST_NODE_TYPE_C_LONGDOUBLE:
+        case LAYE_AST_NODE_TYPE_C_BOOL:
+        {
+            node->primitiveType.access = cast(laye_ast_type_access) ast_cache_read_uint(r);
+            node->primitiveType.size = cast(int) cast(u32) ast_cache_read_uint(r);
+            node->primitiveType.isNilable = ast_cache_read_bool(r);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_ARRAY:
+        case LAYE_AST_NODE_TYPE_SLICE:
+        case LAYE_AST_NODE_TYPE_POINTER:
+        case LAYE_AST_NODE_TYPE_BUFFER:
+        {
+            node->containerType.access = cast(laye_ast_type_access) ast_cache_read_uint(r);
+            node->containerType.elementType = ast_cache_read_node(r);
+            node->containerType.ranks = ast_cache_read_node_list(r);
+            node->containerType.isNilable = ast_cache_read_bool(r);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_NAMED:
+        {
+            node->lookupType.path = ast_cache_read_symbol_list(r);
+            node->lookupType.templateArguments = ast_cache_read_template_arguments(r);
+            node->lookupType.isHeadless = ast_cache_read_bool(r);
+            node->lookupType.isGlobal = ast_cache_read_bool(r);
+            node->lookupType.isNilable = ast_cache_read_bool(r);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_FUNCTION:
+        {
+            node->functionType.returnType = ast_cache_read_node(r);
+            node->functionType.parameterTypes = ast_cache_read_node_list(r);
+            node->functionType.varargsKind = cast(laye_ast_varargs_kind) ast_cache_read_uint(r);
+            node->functionType.isNilable = ast_cache_read_bool(r);
+        } break;
+
+        case LAYE_AST_NODE_TYPE_ERROR:
+        {
+            node->errorUnionType.valueType = ast_cache_read_node(r);
+            node->errorUnionType.errorPath = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_BINDING_DECLARATION:
+        {
+            node->bindingDeclaration.modifiers = ast_cache_read_modifiers(r);
+            node->bindingDeclaration.declaredType = ast_cache_read_node(r);
+            node->bindingDeclaration.name = ast_cache_read_symbol(r);
+            node->bindingDeclaration.initialValue = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_FUNCTION_DECLARATION:
+        {
+            node->functionDeclaration.modifiers = ast_cache_read_modifiers(r);
+            node->functionDeclaration.returnType = ast_cache_read_node(r);
+            node->functionDeclaration.name = ast_cache_read_symbol(r);
+            node->functionDeclaration.isOperator = ast_cache_read_bool(r);
+            node->functionDeclaration.operator = cast(laye_token_kind) ast_cache_read_uint(r);
+            node->functionDeclaration.templateParameters = ast_cache_read_template_parameters(r);
+            node->functionDeclaration.parameterBindings = ast_cache_read_node_list(r);
+            node->functionDeclaration.varargsKind = cast(laye_ast_varargs_kind) ast_cache_read_uint(r);
+            node->functionDeclaration.body = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_STRUCT_DECLARATION:
+        {
+            node->structDeclaration.modifiers = ast_cache_read_modifiers(r);
+            node->structDeclaration.name = ast_cache_read_symbol(r);
+            node->structDeclaration.templateParameters = ast_cache_read_template_parameters(r);
+            node->structDeclaration.fieldBindings = ast_cache_read_node_list(r);
+
+            usize variantCount = ast_cache_read_count(r);
+            if (variantCount > 0)
+                arena_list_init(r->astArena, node->structDeclaration.variants, variantCount);
+
+            for (usize i = 0; i < variantCount; i++)
+            {
+                laye_ast_struct_variant variant = { 0 };
+                variant.name = ast_cache_read_symbol(r);
+                variant.fieldBindings = ast_cache_read_node_list(r);
+                variant.isVoid = ast_cache_read_bool(r);
+                arrput(node->structDeclaration.variants, variant);
+            }
+        } break;
+
+        case LAYE_AST_NODE_ENUM_DECLARATION:
+        {
+            node->enumDeclaration.modifiers = ast_cache_read_modifiers(r);
+            node->enumDeclaration.name = ast_cache_read_symbol(r);
+            node->enumDeclaration.templateParameters = ast_cache_read_template_parameters(r);
+
+            usize variantCount = ast_cache_read_count(r);
+            if (variantCount > 0)
+                arena_list_init(r->astArena, node->enumDeclaration.variants, variantCount);
+
+            for (usize i = 0; i < variantCount; i++)
+            {
+                laye_ast_enum_variant variant = { 0 };
+                variant.name = ast_cache_read_symbol(r);
+                variant.value = ast_cache_read_node(r);
+                arrput(node->enumDeclaration.variants, variant);
+            }
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_BLOCK:
+        {
+            node->statements = ast_cache_read_node_list(r);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_ASSIGNMENT:
+        {
+            node->assignment.target = ast_cache_read_node(r);
+            node->assignment.value = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_IF:
+        {
+            usize conditionalCount = ast_cache_read_count(r);
+            if (conditionalCount > 0)
+                arena_list_init(r->astArena, node->_if.conditionals, conditionalCount);
+
+            for (usize i = 0; i < conditionalCount; i++)
+            {
+                laye_ast_conditional conditional = { 0 };
+                conditional.condition = ast_cache_read_node(r);
+                conditional.body = ast_cache_read_node(r);
+                arrput(node->_if.conditionals, conditional);
+            }
+
+            node->_if.fail = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_BREAK:
+        {
+            node->_break.target = ast_cache_read_symbol(r);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_CONTINUE:
+        {
+            node->_continue.target = ast_cache_read_symbol(r);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_WHILE:
+        case LAYE_AST_NODE_STATEMENT_DO_WHILE:
+        {
+            node->_while.condition = ast_cache_read_node(r);
+            node->_while.body = ast_cache_read_node(r);
+            node->_while.fail = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_STATEMENT_RETURN:
+        case LAYE_AST_NODE_STATEMENT_YIELD:
+        case LAYE_AST_NODE_STATEMENT_YIELD_RETURN:
+        {
+            node->returnValue = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_LOOKUP:
+        {
+            node->lookup.path = ast_cache_read_symbol_list(r);
+            node->lookup.templateArguments = ast_cache_read_template_arguments(r);
+            node->lookup.isHeadless = ast_cache_read_bool(r);
+            node->lookup.isGlobal = ast_cache_read_bool(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_BOOL:
+        {
+            node->literal.boolValue = ast_cache_read_bool(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_STRING:
+        {
+            node->literal.stringValue = ast_cache_read_string(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INTEGER:
+        {
+            node->literal.integerValue = ast_cache_read_uint(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_BINARY:
+        {
+            node->binary.lhs = ast_cache_read_node(r);
+            node->binary.rhs = ast_cache_read_node(r);
+            node->binary.operatorKind = cast(laye_token_kind) ast_cache_read_uint(r);
+            node->binary.operatorString = ast_cache_read_symbol(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INVOKE:
+        {
+            node->invoke.target = ast_cache_read_node(r);
+            node->invoke.arguments = ast_cache_read_node_list(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_TRY:
+        {
+            node->try.target = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CATCH:
+        {
+            node->catch.target = ast_cache_read_node(r);
+            node->catch.captureName = ast_cache_read_symbol(r);
+            node->catch.body = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_CONSTRUCTOR:
+        {
+            node->constructor.typeName = ast_cache_read_node(r);
+            node->constructor.values = ast_cache_read_constructor_values(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_SLICE:
+        {
+            node->slice.target = ast_cache_read_node(r);
+            node->slice.offset = ast_cache_read_node(r);
+            node->slice.length = ast_cache_read_node(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_INDEX:
+        {
+            node->container_index.target = ast_cache_read_node(r);
+            node->container_index.arguments = ast_cache_read_node_list(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_FIELD_INDEX:
+        {
+            node->field_index.target = ast_cache_read_node(r);
+            node->field_index.name = ast_cache_read_symbol(r);
+        } break;
+
+        case LAYE_AST_NODE_EXPRESSION_NEW:
+        {
+            node->new.allocator = ast_cache_read_node(r);
+            node->new.type = ast_cache_read_node(r);
+            node->new.values = ast_cache_read_constructor_values(r);
+        } break;
+    }
+
+    return node;
+}
+
+u64 laye_ast_cache_hash_source(layec_context* context, layec_fileid fileId)
+{
+    string source = layec_context_get_file_source(context, fileId);
+    return string_view_hash(string_slice(source, 0, source.count));
+}
+
+// the path of the file a tree is cached in, release it with `deallocate`.
+static const char* ast_cache_file_path(layec_context* context, u64 sourceHash)
+{
+    char fileName[32];
+    snprintf(fileName, sizeof fileName, "%016llx.layeast", cast(unsigned long long) sourceHash);
+
+    string_view fileNameView = { .memory = cast(const uchar*) fileName, .count = strlen(fileName) };
+    string path = platform_path_combine(context->astCacheDirectory, fileNameView);
+    const char* pathCString = string_view_to_cstring(string_slice(path, 0, path.count), nullptr);
+    string_deallocate(path);
+    return pathCString;
+}
+
+static void ast_cache_write_header(ast_cache_writer* w, u64 sourceHash, usize sourceLength, u64 payloadHash)
+{
+    string_view magic = { .memory = astCacheMagic, .count = sizeof astCacheMagic };
+    string_builder_append_view(w->output, magic);
+    ast_cache_write_uint(w, LAYE_AST_CACHE_VERSION);
+    ast_cache_write_uint(w, sourceHash);
+    ast_cache_write_uint(w, sourceLength);
+    ast_cache_write_uint(w, payloadHash);
+}
+
+bool laye_ast_cache_load(layec_context* context, layec_fileid fileId, u64 sourceHash, arena_allocator* constantArena, laye_parse_result* result)
+{
+    assert(context != nullptr);
+    assert(constantArena != nullptr);
+    assert(result != nullptr);
+
+    if (context->astCacheDirectory.count == 0)
+        return false;
+
+    const char* path = ast_cache_file_path(context, sourceHash);
+    platform_read_file_status readStatus = 0;
+    string cache = platform_read_file(path, nullptr, &readStatus);
+    deallocate(default_allocator, cast(void*) path);
+
+    if (readStatus != KOS_PLATFORM_READ_FILE_SUCCESS)
+    {
+        platform_free_file(cache);
+        return false;
+    }
+
+    layec_timer_scope loadScope;
+    layec_timer_begin(context, &loadScope, "load cached ast", fileId);
+
+    string source = layec_context_get_file_source(context, fileId);
+    ast_cache_reader reader = {
+        .context = context,
+        .baseOffset = layec_context_get_file_base_offset(context, fileId),
+        .sourceLength = source.count,
+        .astArena = arena_create_virtual(default_allocator, 256 * 1024 * 1024),
+        .constantArena = constantArena,
+        .memory = cache.memory,
+        .count = cache.count,
+        .isValid = cache.count >= sizeof astCacheMagic && 0 == memcmp(cache.memory, astCacheMagic, sizeof astCacheMagic),
+    };
+
+    ast_cache_reader* r = &reader;
+    r->position = sizeof astCacheMagic;
+
+    // a different hash means two sources collided on the file name, a different length that the hashes collided.
+    if (ast_cache_read_uint(r) != LAYE_AST_CACHE_VERSION || ast_cache_read_uint(r) != sourceHash || ast_cache_read_uint(r) != source.count)
+        r->isValid = false;
+
+    u64 payloadHash = ast_cache_read_uint(r);
+    string_view payload = { .memory = r->memory + r->position, .count = r->count - r->position };
+    if (r->isValid && string_view_hash(payload) != payloadHash)
+        r->isValid = false;
+
+    usize symbolCount = ast_cache_read_count(r);
+    for (usize i = 0; i < symbolCount && r->isValid; i++)
+    {
+        usize nameLength = ast_cache_read_count(r);
+        string_view name = { .memory = r->memory + r->position, .count = nameLength };
+        r->position += nameLength;
+        arrput(r->symbols, layec_intern_symbol(context, name));
+    }
+
+    laye_ast ast = { .fileId = fileId };
+
+    usize importCount = ast_cache_read_count(r);
+    if (importCount > 0)
+        arena_list_init(r->astArena, ast.imports, importCount);
+
+    for (usize i = 0; i < importCount; i++)
+    {
+        laye_ast_import import = { 0 };
+        import.location = ast_cache_read_location(r);
+        import.name = ast_cache_read_symbol(r);
+        import.alias = ast_cache_read_symbol(r);
+        import.allMembers = ast_cache_read_bool(r);
+        import.explicitMembers = ast_cache_read_symbol_list(r);
+        import.export = ast_cache_read_bool(r);
+        arrput(ast.imports, import);
+    }
+
+    usize topLevelNodeCount = ast_cache_read_count(r);
+    if (topLevelNodeCount > 0)
+        arena_list_init(r->astArena, ast.topLevelNodes, topLevelNodeCount);
+
+    for (usize i = 0; i < topLevelNodeCount; i++)
+        arrput(ast.topLevelNodes, ast_cache_read_node(r));
+
+    bool isLoaded = r->isValid && r->position == r->count;
+
+    arrfree(r->symbols);
+    platform_free_file(cache);
+
+    if (isLoaded)
+        *result = (laye_parse_result){ .status = LAYE_PARSE_OK, .ast = ast, .astArena = r->astArena };
+    else arena_destroy(r->astArena);
+
+    layec_timer_end(context, &loadScope);
+    return isLoaded;
+}
+
+void laye_ast_cache_store(layec_context* context, u64 sourceHash, laye_ast* ast)
+{
+    assert(context != nullptr);
+    assert(ast != nullptr);
+
+    if (context->astCacheDirectory.count == 0)
+        return;
+
+    layec_timer_scope storeScope;
+    layec_timer_begin(context, &storeScope, "store cached ast", ast->fileId);
+
+    string_builder body = { 0 };
+    string_builder_init(&body, default_allocator);
+
+    ast_cache_writer writer = {
+        .context = context,
+        .baseOffset = layec_context_get_file_base_offset(context, ast->fileId),
+        .output = &body,
+        .isValid = true,
+    };
+
+    ast_cache_writer* w = &writer;
+
+    ast_cache_write_uint(w, arrlenu(ast->imports));
+    for (usize i = 0; i < arrlenu(ast->imports); i++)
+    {
+        laye_ast_import import = ast->imports[i];
+        ast_cache_write_location(w, import.location);
+        ast_cache_write_symbol(w, import.name);
+        ast_cache_write_symbol(w, import.alias);
+        ast_cache_write_bool(w, import.allMembers);
+        ast_cache_write_symbol_list(w, import.explicitMembers);
+        ast_cache_write_bool(w, import.export);
+    }
+
+    ast_cache_write_node_list(w, ast->topLevelNodes);
+
+    // the string table goes in front of the tree, so it's known before any name has to be looked up while loading.
+    string_builder payload = { 0 };
+    string_builder_init(&payload, default_allocator);
+    w->output = &payload;
+
+    ast_cache_write_uint(w, arrlenu(w->symbols));
+    for (usize i = 0; i < arrlenu(w->symbols); i++)
+        ast_cache_write_string(w, layec_symbol_name(context, w->symbols[i]));
+
+    string_view bodyView = { .memory = body.memory, .count = body.count };
+    string_builder_append_view(&payload, bodyView);
+    string_view payloadView = { .memory = payload.memory, .count = payload.count };
+
+    string_builder head = { 0 };
+    string_builder_init(&head, default_allocator);
+    w->output = &head;
+
+    string source = layec_context_get_file_source(context, ast->fileId);
+    ast_cache_write_header(w, sourceHash, source.count, string_view_hash(payloadView));
+
+    if (w->isValid)
+    {
+        const char* path = ast_cache_file_path(context, sourceHash);
+
+        // the cache is written under a name of its own then renamed, so no one ever reads a partly written cache.
+        char temporaryPath[1024];
+        snprintf(temporaryPath, sizeof temporaryPath, "%s.%zu.%llu.tmp", path, ast->fileId,
+            cast(unsigned long long) platform_monotonic_nanoseconds());
+
+        FILE* stream = fopen(temporaryPath, "wb");
+        if (stream != nullptr)
+        {
+            bool isWritten = head.count == fwrite(head.memory, 1, head.count, stream);
+            isWritten = payload.count == fwrite(payload.memory, 1, payload.count, stream) && isWritten;
+            isWritten = 0 == fclose(stream) && isWritten;
+
+            if (!isWritten || 0 != rename(temporaryPath, path))
+                remove(temporaryPath);
+        }
+
+        deallocate(default_allocator, cast(void*) path);
+    }
+
+    hmfree(w->symbolIndices);
+    arrfree(w->symbols);
+    string_builder_deallocate(&head);
+    string_builder_deallocate(&payload);
+    string_builder_deallocate(&body);
+
+    layec_timer_end(context, &storeScope);
+}
@@ -1,5 +1,6 @@
 #include "kos/kos.h"
 #include "kos/ansi.h"
+#include "kos/thread.h"
 
 #include "layec/front/laye/front.h"
 
@@ -10,51 +11,233 @@
 typedef struct laye_parse_data
 {
     layec_fileid fileId;
+    laye_parse_result_status status;
     laye_ast ast;
     arena_allocator* astArena;
+    // diagnostics issued while parsing this file, reported once every file has been parsed.
+    layec_diagnostic_capture diagnostics;
+    // the file each of `ast.imports` resolved to, or 0 if it could not be resolved.
+    list(layec_fileid) importFileIds;
+    bool isReported;
 } laye_parse_data;
 
-static bool is_file_already_parsed(list(laye_parse_data) parseData, layec_fileid fileId)
+typedef struct laye_parse_worker laye_parse_worker;
+
+// files are parsed by a pool of workers, each with its own queue of files.
+// a worker takes the newest file from its own queue and, when that runs dry, steals the oldest from another worker.
+// the imports of a parsed file are queued on the worker which parsed it.
+typedef struct laye_parse_pool
+{
+    layec_context* context;
+    // guards `parseDataByFileId`, `pendingCount` and `queuedCount`.
+    kos_mutex* mutex;
+    kos_condition* workAvailable;
+    // indexed by file id, nullptr until a file is claimed for parsing.
+    list(laye_parse_data*) parseDataByFileId;
+    // the number of claimed files which have not finished parsing.
+    usize pendingCount;
+    // the number of files waiting in a worker's queue.
+    usize queuedCount;
+    laye_parse_worker* workers;
+    usize workerCount;
+} laye_parse_pool;
+
+struct laye_parse_worker
 {
-    for (usize i = 0, iLen = arrlenu(parseData); i < iLen; i++)
+    laye_parse_pool* pool;
+    usize index;
+    arena_allocator* constantArena;
+    kos_mutex* queueMutex;
+    list(laye_parse_data*) queue;
+    kos_thread* thread;
+};
+
+static void parse_pool_claim_file(laye_parse_worker* worker, layec_fileid fileId)
+{
+    laye_parse_pool* pool = worker->pool;
+
+    mutex_lock(pool->mutex);
+
+    while (arrlenu(pool->parseDataByFileId) <= fileId)
+        arrput(pool->parseDataByFileId, nullptr);
+
+    if (pool->parseDataByFileId[fileId] != nullptr)
     {
-        if (parseData[i].fileId == fileId)
-            return true;
+        mutex_unlock(pool->mutex);
+        return;
     }
 
-    return false;
+    laye_parse_data* data = allocate(default_allocator, sizeof(laye_parse_data));
+    assert(data != nullptr);
+    *data = (laye_parse_data){ .fileId = fileId };
+
+    pool->parseDataByFileId[fileId] = data;
+    pool->pendingCount++;
+    // counted before the file is queued, so a worker which takes it straight away never drops the count below 0.
+    pool->queuedCount++;
+
+    mutex_unlock(pool->mutex);
+
+    mutex_lock(worker->queueMutex);
+    arrput(worker->queue, data);
+    mutex_unlock(worker->queueMutex);
+
+    mutex_lock(pool->mutex);
+    condition_signal(pool->workAvailable);
+    mutex_unlock(pool->mutex);
 }
 
-static laye_parse_result_status parse_file(layec_context* context, list(laye_parse_data)* parseData, layec_fileid fileId)
+static laye_parse_data* parse_worker_take(laye_parse_worker* worker)
 {
-    laye_parse_result parseResult = laye_parse(context, fileId);
-    if (parseResult.status != LAYE_PARSE_OK)
-        return parseResult.status;
-    
-    laye_parse_data d = {
-        .fileId = fileId,
-        .ast = parseResult.ast,
-        .astArena = parseResult.astArena,
-    };
+    laye_parse_pool* pool = worker->pool;
+    laye_parse_data* data = nullptr;
+
+    mutex_lock(worker->queueMutex);
+    if (arrlenu(worker->queue) > 0)
+        data = arrpop(worker->queue);
+    mutex_unlock(worker->queueMutex);
+
+    for (usize i = 1; data == nullptr && i < pool->workerCount; i++)
+    {
+        laye_parse_worker* victim = &pool->workers[(worker->index + i) % pool->workerCount];
+
+        mutex_lock(victim->queueMutex);
+        if (arrlenu(victim->queue) > 0)
+        {
+            data = victim->queue[0];
+            arrdel(victim->queue, 0);
+        }
+        mutex_unlock(victim->queueMutex);
+    }
+
+    if (data != nullptr)
+    {
+        mutex_lock(pool->mutex);
+        pool->queuedCount--;
+        mutex_unlock(pool->mutex);
+    }
+
+    return data;
+}
+
+static void parse_worker_parse_file(laye_parse_worker* worker, laye_parse_data* data)
+{
+    layec_context* context = worker->pool->context;
+
+    layec_set_diagnostic_capture(&data->diagnostics);
+
+    // a file whose tree is cached is neither lexed nor parsed.
+    bool isCaching = context->astCacheDirectory.count != 0;
+    u64 sourceHash = isCaching ? laye_ast_cache_hash_source(context, data->fileId) : 0;
+
+    laye_parse_result parseResult = { 0 };
+    if (!isCaching || !laye_ast_cache_load(context, data->fileId, sourceHash, worker->constantArena, &parseResult))
+    {
+        layec_timer_scope parseScope;
+        layec_timer_begin(context, &parseScope, "parse", data->fileId);
+        parseResult = laye_parse(context, data->fileId, worker->constantArena);
+        layec_timer_end(context, &parseScope);
+
+        // only trees parsed without a single diagnostic are cached, so loading one never has to reissue any.
+        if (isCaching && parseResult.status == LAYE_PARSE_OK && arrlenu(data->diagnostics.diagnostics) == 0)
+            laye_ast_cache_store(context, sourceHash, &parseResult.ast);
+    }
+
+    data->status = parseResult.status;
+    data->ast = parseResult.ast;
+    data->astArena = parseResult.astArena;
+
+    if (parseResult.status == LAYE_PARSE_OK)
+    {
+        layec_timer_scope importScope;
+        layec_timer_begin(context, &importScope, "resolve imports", data->fileId);
+
+        string_view thisFileFullName = layec_context_get_file_full_path(context, data->fileId);
+        for (usize j = 0, jLen = arrlenu(data->ast.imports); j < jLen; j++)
+        {
+            laye_ast_import import = data->ast.imports[j];
+            // TODO(local): resolve this against various import locations and also lookup package names
+            string importName = layec_symbol_name(context, import.name);
+            string_view name = string_slice(importName, 0, importName.count);
+            layec_fileid importFileId = layec_context_add_file(context, name, thisFileFullName);
+            arrput(data->importFileIds, importFileId);
+
+            if (importFileId != 0)
+                parse_pool_claim_file(worker, importFileId);
+        }
+
+        layec_timer_end(context, &importScope);
+    }
+
+    layec_set_diagnostic_capture(nullptr);
+}
+
+static void parse_worker_run(void* argument)
+{
+    laye_parse_worker* worker = argument;
+    laye_parse_pool* pool = worker->pool;
+
+    for (;;)
+    {
+        laye_parse_data* data = parse_worker_take(worker);
+        if (data != nullptr)
+        {
+            parse_worker_parse_file(worker, data);
+
+            mutex_lock(pool->mutex);
+            pool->pendingCount--;
+            if (pool->pendingCount == 0)
+                condition_broadcast(pool->workAvailable);
+            mutex_unlock(pool->mutex);
+
+            continue;
+        }
+
+        mutex_lock(pool->mutex);
+        while (pool->queuedCount == 0 && pool->pendingCount > 0)
+            condition_wait(pool->workAvailable, pool->mutex);
+        bool isFinished = pool->pendingCount == 0;
+        mutex_unlock(pool->mutex);
+
+        if (isFinished)
+            break;
+    }
+}
+
+// reports the diagnostics of a file and, depth first, of its imports, in the same order a single threaded
+// parse would have issued them. every successfully parsed file reached is added to `parseOrder`.
+static laye_parse_result_status report_file(laye_parse_pool* pool, list(laye_parse_data*)* parseOrder, layec_fileid fileId)
+{
+    laye_parse_data* data = pool->parseDataByFileId[fileId];
+    assert(data != nullptr);
+
+    data->isReported = true;
+    layec_replay_diagnostics(pool->context, &data->diagnostics);
 
-    arrput(*parseData, d);
-    
-    string_view thisFileFullName = layec_context_get_file_full_path(context, fileId);
-    for (usize j = 0, jLen = arrlenu(d.ast.imports); j < jLen; j++)
+    if (data->status != LAYE_PARSE_OK)
+        return data->status;
+
+    // nothing past the error limit would be reported, so there's no point going on.
+    if (layec_error_limit_reached(pool->context))
+        return LAYE_PARSE_FAILURE;
+
+    arrput(*parseOrder, data);
+
+    for (usize j = 0, jLen = arrlenu(data->ast.imports); j < jLen; j++)
     {
-        laye_ast_import import = d.ast.imports[j];
-        // TODO(local): resolve this against various import locations and also lookup package names
-        string_view name = string_slice(import.name, 0, import.name.count);
-        layec_fileid importFileId = layec_context_add_file(context, name, thisFileFullName);
+        layec_fileid importFileId = data->importFileIds[j];
         if (importFileId == 0)
         {
-            layec_issue_diagnostic(context, SEV_ERROR, import.location, "Unable to resolve import name '"STRING_VIEW_FORMAT"'", STRING_VIEW_EXPAND(name));
+            laye_ast_import import = data->ast.imports[j];
+            layec_issue_diagnostic(pool->context, SEV_ERROR, import.location, "Unable to resolve import name '"STRING_FORMAT"'", STRING_EXPAND(layec_symbol_name(pool->context, import.name)));
+            if (layec_error_limit_reached(pool->context))
+                return LAYE_PARSE_FAILURE;
             continue;
         }
 
-        if (!is_file_already_parsed(*parseData, importFileId))
+        if (!pool->parseDataByFileId[importFileId]->isReported)
         {
-            laye_parse_result_status importParseStatus = parse_file(context, parseData, importFileId);
+            laye_parse_result_status importParseStatus = report_file(pool, parseOrder, importFileId);
             if (importParseStatus != LAYE_PARSE_OK)
                 return importParseStatus;
         }
@@ -66,27 +249,108 @@ static laye_parse_result_status parse_file(layec_context* context, list(laye_par
 layec_front_end_status laye_front_end_entry(layec_context* context, list(layec_fileid) inputFiles)
 {
     assert(context != nullptr);
-    
+
     if (arrlenu(inputFiles) == 0)
         return LAYEC_FRONT_NO_INPUT_FILES;
 
-    list(laye_parse_data) parseData = nullptr;
+    laye_lexer_init_tables();
+
+    laye_parse_pool pool = {
+        .context = context,
+        .mutex = mutex_create(),
+        .workAvailable = condition_create(),
+        .workerCount = context->jobCount > 1 ? context->jobCount : 1,
+    };
+
+    pool.workers = allocate(default_allocator, pool.workerCount * sizeof(laye_parse_worker));
+    assert(pool.workers != nullptr);
+
+    for (usize i = 0; i < pool.workerCount; i++)
+    {
+        pool.workers[i] = (laye_parse_worker){
+            .pool = &pool,
+            .index = i,
+            .constantArena = i == 0 ? context->constantArena : layec_context_create_constant_arena(context),
+            .queueMutex = mutex_create(),
+        };
+    }
+
+    for (usize i = 0; i < arrlenu(inputFiles); i++)
+        parse_pool_claim_file(&pool.workers[0], inputFiles[i]);
+
+    // the calling thread works as the first worker.
+    for (usize i = 1; i < pool.workerCount; i++)
+        pool.workers[i].thread = thread_create(parse_worker_run, &pool.workers[i]);
+
+    parse_worker_run(&pool.workers[0]);
+
+    for (usize i = 1; i < pool.workerCount; i++)
+        thread_join(pool.workers[i].thread);
+
+    layec_front_end_status status = LAYEC_FRONT_SUCCESS;
+
+    list(laye_parse_data*) parseOrder = nullptr;
     for (usize i = 0; i < arrlenu(inputFiles); i++)
     {
-        laye_parse_result_status parseStatus = parse_file(context, &parseData, inputFiles[i]);
+        if (pool.parseDataByFileId[inputFiles[i]]->isReported)
+            continue;
+
+        laye_parse_result_status parseStatus = report_file(&pool, &parseOrder, inputFiles[i]);
         if (parseStatus != LAYE_PARSE_OK)
-            return LAYEC_FRONT_PARSE_FAILED;
+        {
+            status = LAYEC_FRONT_PARSE_FAILED;
+            break;
+        }
     }
 
-    for (usize i = 0; i < arrlenu(parseData); i++)
+    if (status == LAYEC_FRONT_SUCCESS && context->astDumpFormat != LAYEC_AST_DUMP_FORMAT_NONE)
     {
-        laye_parse_data d = parseData[i];
-        laye_ast_fprint(stderr, context, &d.ast, true);
+        for (usize i = 0; i < arrlenu(parseOrder); i++)
+        {
+            laye_parse_data* d = parseOrder[i];
+
+            layec_timer_scope printScope;
+            layec_timer_begin(context, &printScope, "print", d->ast.fileId);
+            if (context->astDumpFormat == LAYEC_AST_DUMP_FORMAT_JSON)
+                laye_ast_fprint_json(stdout, context, &d->ast);
+            else laye_ast_fprint(stdout, context, &d->ast, true);
+            layec_timer_end(context, &printScope);
+        }
     }
 
     // once we're done generating IR, destroy the AST memory arenas
-    for (usize i = 0; i < arrlenu(parseData); i++)
-        arena_destroy(parseData[i].astArena);
+    for (usize i = 0; i < arrlenu(pool.parseDataByFileId); i++)
+    {
+        laye_parse_data* d = pool.parseDataByFileId[i];
+        if (d == nullptr)
+            continue;
+
+        if (d->astArena != nullptr)
+        {
+            layec_context_record_arena(context, "ast", d->astArena);
+            arena_destroy(d->astArena);
+        }
+
+        // diagnostics of files after a failed parse are never reported.
+        for (usize j = 0; j < arrlenu(d->diagnostics.diagnostics); j++)
+            string_deallocate(d->diagnostics.diagnostics[j].message);
+        arrfree(d->diagnostics.diagnostics);
+
+        arrfree(d->importFileIds);
+        deallocate(default_allocator, d);
+    }
+
+    for (usize i = 0; i < pool.workerCount; i++)
+    {
+        arrfree(pool.workers[i].queue);
+        mutex_destroy(pool.workers[i].queueMutex);
+    }
+
+    arrfree(parseOrder);
+    arrfree(pool.parseDataByFileId);
+    deallocate(default_allocator, pool.workers);
+    condition_destroy(pool.workAvailable);
+    mutex_destroy(pool.mutex);
 
-    return LAYEC_FRONT_SUCCESS;
+    return status;
 }
@@ -1,3 +1,4 @@
+#include "kos/scan.h"
 #include "kos/utf8.h"
 
 #include "layec/front/laye/front.h"
@@ -5,24 +6,9 @@
 #include "layec/compiler.h"
 
 #include "ast.h"
+#include "parser.h"
 #include "token.h"
 
-typedef struct laye_lexer
-{
-    layec_context* context;
-    layec_fileid fileId;
-    arena_allocator* tokenArena;
-    string sourceText;
-    rune currentRune;
-    usize currentPosition;
-} laye_lexer;
-
-static laye_token* laye_token_alloc(laye_lexer* l)
-{
-    laye_token* result = arena_push(l->tokenArena, sizeof(laye_token));
-    return result;
-}
-
 typedef struct keyword_info
 {
     laye_token_kind kind;
@@ -41,12 +27,98 @@ LAYE_TOKEN_KINDS
 
 #define LAYE_KEYWORD_COUNT (cast(size_t) (sizeof(keywords) / sizeof(keyword_info)))
 
+// must be a power of two and comfortably larger than the keyword count to keep probes short.
+#define LAYE_KEYWORD_TABLE_SIZE 256
+
+typedef struct layec_keyword_slot
+{
+    laye_token_kind kind;
+    usize length;
+    const char* image;
+} layec_keyword_slot;
+
+static layec_keyword_slot keywordTable[LAYE_KEYWORD_TABLE_SIZE];
+static usize keywordMaxLength = 0;
+static bool isKeywordTableBuilt = false;
+
+static void lexer_build_keyword_table(void)
+{
+    if (isKeywordTableBuilt)
+        return;
+
+    for (usize i = 0; keywords[i].kind != 0; i++)
+    {
+        string_view image = { cast(const uchar*) keywords[i].image, strlen(keywords[i].image) };
+        if (image.count > keywordMaxLength)
+            keywordMaxLength = image.count;
+
+        usize slot = cast(usize) string_view_hash(image) & (LAYE_KEYWORD_TABLE_SIZE - 1);
+        while (keywordTable[slot].kind != 0)
+            slot = (slot + 1) & (LAYE_KEYWORD_TABLE_SIZE - 1);
+
+        keywordTable[slot] = (layec_keyword_slot){ keywords[i].kind, image.count, keywords[i].image };
+    }
+
+    isKeywordTableBuilt = true;
+}
+
+static laye_token_kind lexer_lookup_keyword(string_view image)
+{
+    assert(isKeywordTableBuilt);
+
+    if (image.count > keywordMaxLength)
+        return LAYE_TOKEN_INVALID;
+
+    usize slot = cast(usize) string_view_hash(image) & (LAYE_KEYWORD_TABLE_SIZE - 1);
+    while (keywordTable[slot].kind != 0)
+    {
+        layec_keyword_slot kw = keywordTable[slot];
+        if (kw.length == image.count && 0 == memcmp(image.memory, kw.image, image.count))
+            return kw.kind;
+
+        slot = (slot + 1) & (LAYE_KEYWORD_TABLE_SIZE - 1);
+    }
+
+    return LAYE_TOKEN_INVALID;
+}
+
+#define LEX_SPACE           0x01
+#define LEX_IDENT_START     0x02
+#define LEX_IDENT_CONTINUE  0x04
+#define LEX_DIGIT           0x08
+
+#define LEX_ID (LEX_IDENT_START | LEX_IDENT_CONTINUE)
+#define LEX_DG (LEX_IDENT_CONTINUE | LEX_DIGIT)
+
+// character classes for the ASCII range, every byte >= 0x80 is part of a multi-byte rune and has no class.
+static const u8 lexerCharClasses[256] = {
+    [' '] = LEX_SPACE, ['\r'] = LEX_SPACE, ['\n'] = LEX_SPACE, ['\t'] = LEX_SPACE,
+    ['_'] = LEX_ID,
+    ['A'] = LEX_ID, ['B'] = LEX_ID, ['C'] = LEX_ID, ['D'] = LEX_ID, ['E'] = LEX_ID, ['F'] = LEX_ID, ['G'] = LEX_ID, ['H'] = LEX_ID,
+    ['I'] = LEX_ID, ['J'] = LEX_ID, ['K'] = LEX_ID, ['L'] = LEX_ID, ['M'] = LEX_ID, ['N'] = LEX_ID, ['O'] = LEX_ID, ['P'] = LEX_ID,
+    ['Q'] = LEX_ID, ['R'] = LEX_ID, ['S'] = LEX_ID, ['T'] = LEX_ID, ['U'] = LEX_ID, ['V'] = LEX_ID, ['W'] = LEX_ID, ['X'] = LEX_ID,
+    ['Y'] = LEX_ID, ['Z'] = LEX_ID, ['a'] = LEX_ID, ['b'] = LEX_ID, ['c'] = LEX_ID, ['d'] = LEX_ID, ['e'] = LEX_ID, ['f'] = LEX_ID,
+    ['g'] = LEX_ID, ['h'] = LEX_ID, ['i'] = LEX_ID, ['j'] = LEX_ID, ['k'] = LEX_ID, ['l'] = LEX_ID, ['m'] = LEX_ID, ['n'] = LEX_ID,
+    ['o'] = LEX_ID, ['p'] = LEX_ID, ['q'] = LEX_ID, ['r'] = LEX_ID, ['s'] = LEX_ID, ['t'] = LEX_ID, ['u'] = LEX_ID, ['v'] = LEX_ID,
+    ['w'] = LEX_ID, ['x'] = LEX_ID, ['y'] = LEX_ID, ['z'] = LEX_ID,
+    ['0'] = LEX_DG, ['1'] = LEX_DG, ['2'] = LEX_DG, ['3'] = LEX_DG, ['4'] = LEX_DG,
+    ['5'] = LEX_DG, ['6'] = LEX_DG, ['7'] = LEX_DG, ['8'] = LEX_DG, ['9'] = LEX_DG,
+};
+
+#undef LEX_DG
+#undef LEX_ID
+
+static bool lexer_byte_is(laye_lexer* l, usize position, u8 charClass)
+{
+    return position < l->sourceText.count && (lexerCharClasses[l->sourceText.memory[position]] & charClass) != 0;
+}
+
 static bool lexer_is_eof(laye_lexer* l)
 {
     return l->currentRune == 0 || l->currentPosition >= l->sourceText.count;
 }
 
-static char lexer_current(laye_lexer* l)
+static rune lexer_current(laye_lexer* l)
 {
     return l->currentRune;
 }
@@ -77,38 +149,61 @@ static char lexer_peek(laye_lexer* l, int ahead)
 static layec_location lexer_location(laye_lexer* l, usize startPosition)
 {
     return (layec_location){
-        .fileId = l->fileId,
-        .offset = startPosition,
-        .length = l->currentPosition - startPosition,
+        .offset = l->baseOffset + cast(u32) startPosition,
+        .length = cast(u32) (l->currentPosition - startPosition),
     };
 }
 
-static void lexer_advance(laye_lexer* l)
+static void lexer_set_position(laye_lexer* l, usize position)
 {
-    if (lexer_is_eof(l))
-        return;
-
-    rune lastCurrent = l->currentRune;
+    // a NUL or an invalid UTF-8 sequence is reported and skipped a byte at a time, neither ends the source early.
+    for (;; position++)
+    {
+        l->currentPosition = position;
 
-    int currentByteCount = utf8_calc_encoded_byte_count(l->sourceText.memory[l->currentPosition]);
-    l->currentPosition += currentByteCount;
+        if (position >= l->sourceText.count)
+        {
+            l->currentRune = 0;
+            return;
+        }
 
-    utf8_decode_result decodeResult = utf8_decode_rune_at_string_position(l->sourceText, l->currentPosition);
+        // nearly all source is ASCII, only fall back to rune decoding for multi-byte sequences.
+        u8 currentByte = l->sourceText.memory[position];
+        if (currentByte != 0 && currentByte < 0x80)
+        {
+            l->currentRune = currentByte;
+            return;
+        }
 
-    l->currentRune = decodeResult.value;
-    
-    // the source text should include a nul terminator, so check for at least 1 before that.
-    if (l->currentRune == 0 && l->currentPosition < l->sourceText.count - 1)
-    {
-        // if we hit this case, prove that the previous assumption is true
-        assert(l->sourceText.memory[l->sourceText.count - 1] == 0);
+        layec_location location = { .offset = l->baseOffset + cast(u32) position, .length = 1 };
+        if (currentByte == 0)
+        {
+            layec_issue_diagnostic(l->context, SEV_ERROR, location, "Unexpected NUL character in source.");
+            continue;
+        }
 
-        layec_issue_diagnostic(l->context, SEV_ERROR, lexer_location(l, l->currentPosition - decodeResult.nBytesRead), "Unexpected NUL character in source.");
+        utf8_decode_result decodeResult = utf8_decode_rune_at_string_position(l->sourceText, position);
+        if (decodeResult.kind == UTF8_DECODE_OK && decodeResult.value != 0)
+        {
+            l->currentRune = decodeResult.value;
+            return;
+        }
 
-        lexer_advance(l);
+        layec_issue_diagnostic(l->context, SEV_ERROR, location, "Invalid UTF-8 byte in source.");
     }
 }
 
+static void lexer_advance(laye_lexer* l)
+{
+    if (lexer_is_eof(l))
+        return;
+
+    u8 currentByte = l->sourceText.memory[l->currentPosition];
+    if (currentByte < 0x80)
+        lexer_set_position(l, l->currentPosition + 1);
+    else lexer_set_position(l, l->currentPosition + utf8_calc_encoded_byte_count(currentByte));
+}
+
 static bool lexer_is_space(rune value)
 {
     return value == ' '
@@ -119,22 +214,19 @@ static bool lexer_is_space(rune value)
 
 static void lexer_skip_whitespace(laye_lexer* l)
 {
-    rune current = lexer_current(l);
-    while (lexer_is_space(current))
-    {
-        lexer_advance(l);
-        current = lexer_current(l);
-    }
+    if (!lexer_is_space(lexer_current(l)))
+        return;
+
+    lexer_set_position(l, scan_skip_whitespace(l->sourceText.memory, l->currentPosition + 1, l->sourceText.count));
 }
 
-static laye_token* lexer_get_token(laye_lexer* l)
+static bool lexer_get_token(laye_lexer* l, laye_token* token)
 {
     lexer_skip_whitespace(l);
     if (lexer_is_eof(l))
-        return NULL;
+        return false;
 
-    laye_token* token = laye_token_alloc(l);
-    assert(token->location.fileId == 0, "after allocating token");
+    assert(token->location.offset == 0, "at start of token");
 
     usize startPosition = l->currentPosition;
     
@@ -164,14 +256,13 @@ static laye_token* lexer_get_token(laye_lexer* l)
             bool isSizedTypeParamterOutOfRange = false;
             bool areAllSubsequentCharactersDigits = true;
 
-            lexer_advance(l);
-            while ((c = lexer_current(l)),
-                (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' ||
-                (c >= '0' && c <= '9'))
+            usize position = startPosition + 1;
+            while (lexer_byte_is(l, position, LEX_IDENT_CONTINUE))
             {
+                c = l->sourceText.memory[position];
                 if (areAllSubsequentCharactersDigits)
                 {
-                    if (c >= '0' && c <= '9')
+                    if (lexerCharClasses[c] & LEX_DIGIT)
                     {
                         if (!isSizedTypeParamterOutOfRange)
                         {
@@ -188,9 +279,11 @@ static laye_token* lexer_get_token(laye_lexer* l)
                     else areAllSubsequentCharactersDigits = false;
                 }
 
-                lexer_advance(l);
+                position++;
             }
-            
+
+            lexer_set_position(l, position);
+
             token->kind = LAYE_TOKEN_IDENTIFIER;
             token->location = lexer_location(l, startPosition);
 
@@ -213,18 +306,17 @@ static laye_token* lexer_get_token(laye_lexer* l)
             }
             else
             {
-                for (size_t i = 0; i < keywords[i].kind != 0; i++)
-                {
-                    layec_keyword_info kw = keywords[i];
-                    if (strlen(kw.image) != token->location.length)
-                        continue;
+                string_view image = { l->sourceText.memory + startPosition, token->location.length };
+                laye_token_kind keywordKind = lexer_lookup_keyword(image);
+                if (keywordKind != LAYE_TOKEN_INVALID)
+                    token->kind = keywordKind;
+            }
 
-                    if (0 == strncmp(cast(const char*) (l->sourceText.memory + startPosition), kw.image, token->location.length))
-                    {
-                        token->kind = kw.kind;
-                        break;
-                    }
-                }
+            // identifiers are interned once here so the parser only ever compares and stores their symbols.
+            if (token->kind == LAYE_TOKEN_IDENTIFIER)
+            {
+                string_view image = { l->sourceText.memory + startPosition, token->location.length };
+                token->symbol = layec_intern_symbol(l->context, image);
             }
         } break;
 
@@ -295,7 +387,10 @@ static laye_token* lexer_get_token(laye_lexer* l)
                 token->kind = LAYE_TOKEN_UNKNOWN;
                 token->location = lexer_location(l, startPosition);
 
-                layec_issue_diagnostic(l->context, SEV_ERROR, token->location, "invalid character '%lc' in Laye source file (did you mean `#!` to start a line comment?)", c);
+                // the rune is quoted as it's spelled in the source, formatting it with %lc fails outside of a UTF-8 locale.
+                int runeByteCount = lexer_is_eof(l) ? 0 : utf8_calc_encoded_byte_count(l->sourceText.memory[l->currentPosition]);
+                layec_issue_diagnostic(l->context, SEV_ERROR, token->location, "invalid character '%.*s' in Laye source file (did you mean `#!` to start a line comment?)",
+                    runeByteCount, cast(const char*) l->sourceText.memory + l->currentPosition);
             }
         } break;
 
@@ -306,44 +401,37 @@ static laye_token* lexer_get_token(laye_lexer* l)
             if (c == '/')
             {
                 lexer_advance(l);
-            continue_line_comment:
-                while (!lexer_is_eof(l))
-                {
-                    c = lexer_current(l);
-                    lexer_advance(l);
+            continue_line_comment:;
+                // the comment includes its terminating newline, if there is one.
+                usize newlinePosition = scan_find_newline(l->sourceText.memory, l->currentPosition, l->sourceText.count);
+                if (newlinePosition < l->sourceText.count)
+                    newlinePosition++;
 
-                    if (c == '\n')
-                        break;
-                }
+                lexer_set_position(l, newlinePosition);
 
-                return lexer_get_token(l);
+                return lexer_get_token(l, token);
             }
             else if (c == '*')
             {
-                lexer_advance(l);
                 int delimiterCount = 1;
 
-                char lastChar = lexer_current(l);
-                lexer_advance(l);
-
-                while (!lexer_is_eof(l) && delimiterCount > 0)
+                // the closing "*/" can't share its '*' with the opening "/*".
+                usize endPosition = scan_find_block_comment_end(l->sourceText.memory, startPosition + 2, l->sourceText.count);
+                if (endPosition < l->sourceText.count)
                 {
-                    c = lexer_current(l);
-                    lexer_advance(l);
-
-                    if (c == '/' && lastChar == '*')
-                        delimiterCount--;
-                    
-                    lastChar = c;
+                    delimiterCount--;
+                    endPosition += 2;
                 }
 
+                lexer_set_position(l, endPosition);
+
                 if (delimiterCount > 0)
                 {
                     layec_location location = lexer_location(l, startPosition);
                     layec_issue_diagnostic(l->context, SEV_ERROR, location, "unfinished delimited comment in Laye source file (%d open delimiter(s) went unclosed.)", delimiterCount);
                 }
 
-                return lexer_get_token(l);
+                return lexer_get_token(l, token);
             }
 
             token->kind = cast(laye_token_kind) '/';
@@ -426,26 +514,23 @@ static laye_token* lexer_get_token(laye_lexer* l)
             u64 integerValue = cast(u64) (c - '0');
             bool isIntTooLarge = false;
 
-            lexer_advance(l);
-            while ((c = lexer_current(l)), (c >= '0' && c <= '9'))
+            usize position = startPosition + 1;
+            while (lexer_byte_is(l, position, LEX_DIGIT))
             {
-                u64 digitValue = cast(u64) (c - '0');
+                u64 digitValue = cast(u64) (l->sourceText.memory[position] - '0');
                 if ((U64_MAX - digitValue) / 10 < integerValue)
                     isIntTooLarge = true;
                 
                 if (!isIntTooLarge)
                     integerValue = integerValue * 10 + digitValue;
                 
-                lexer_advance(l);
+                position++;
             }
 
-            if ((c = lexer_current(l)),
-                (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' ||
-                (c >= '0' && c <= '9'))
-            {
-                l->currentPosition = startPosition;
+            if (lexer_byte_is(l, position, LEX_IDENT_CONTINUE))
                 goto lex_identifier;
-            }
+
+            lexer_set_position(l, position);
             
             // TODO(local): lex floats, eventually, when we give a shit about floats
             token->kind = LAYE_TOKEN_LITERAL_INTEGER;
@@ -464,16 +549,16 @@ static laye_token* lexer_get_token(laye_lexer* l)
                 integerValue = 0;
                 isIntTooLarge = false;
 
-                lexer_advance(l);
+                position++;
 
-                bool startsWithUnderscore = lexer_current(l) == '_';
+                bool startsWithUnderscore = lexer_byte_is(l, position, LEX_IDENT_CONTINUE) && l->sourceText.memory[position] == '_';
                 bool endsWithUnderscore = false;
 
-                while ((c = lexer_current(l)),
-                    (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
-                     c == '_' ||
-                    (c >= '0' && c <= '9'))
+                while (lexer_byte_is(l, position, LEX_IDENT_CONTINUE))
                 {
+                    c = l->sourceText.memory[position];
+                    position++;
+
                     if (c == '_')
                     {
                         endsWithUnderscore = true;
@@ -492,9 +577,9 @@ static laye_token* lexer_get_token(laye_lexer* l)
                     
                     if (!isIntTooLarge)
                         integerValue = integerValue * radix + digitValue;
-                    
-                    lexer_advance(l);
                 }
+
+                lexer_set_position(l, position);
             }
 
             token->integerValue = integerValue;
@@ -508,7 +593,7 @@ static laye_token* lexer_get_token(laye_lexer* l)
 
         case '"':
         {
-            assert(token->location.fileId == 0, "at start of string literal");
+            assert(token->location.offset == 0, "at start of string literal");
             lexer_advance(l);
 
             string_builder stringBuilder = { 0 };
@@ -546,10 +631,10 @@ static laye_token* lexer_get_token(laye_lexer* l)
             else lexer_advance(l);
 
             token->kind = LAYE_TOKEN_LITERAL_STRING;
-            token->stringValue = string_builder_to_string_arena(&stringBuilder, l->context->constantArena);
+            token->stringValue = string_builder_to_string_arena(&stringBuilder, l->constantArena);
             string_builder_deallocate(&stringBuilder);
 
-            assert(token->location.fileId == 0, "at end of string literal");
+            assert(token->location.offset == 0, "at end of string literal");
         } break;
 
         default:
@@ -559,45 +644,257 @@ static laye_token* lexer_get_token(laye_lexer* l)
             token->kind = LAYE_TOKEN_UNKNOWN;
             token->location = lexer_location(l, startPosition);
 
-            layec_issue_diagnostic(l->context, SEV_ERROR, token->location, "invalid character '%lc' in Laye source file", c);
+            layec_issue_diagnostic(l->context, SEV_ERROR, token->location, "invalid character '%.*s' in Laye source file",
+                cast(int) (l->currentPosition - startPosition), cast(const char*) l->sourceText.memory + startPosition);
         } break;
     }
     
-    if (token->location.fileId == 0)
+    if (token->location.offset == 0)
         token->location = lexer_location(l, startPosition);
     assert(token->location.length > 0, "at start position %zu", startPosition);
-    assert(token->location.offset < l->sourceText.count, "at start position %zu", startPosition);
+    assert(token->location.offset - l->baseOffset < l->sourceText.count, "at start position %zu", startPosition);
     assert(token->location.length <= l->sourceText.count, "at start position %zu", startPosition);
-    assert(token->location.offset + token->location.length <= l->sourceText.count, "at start position %zu", startPosition);
+    assert(token->location.offset - l->baseOffset + token->location.length <= l->sourceText.count, "at start position %zu", startPosition);
     
     lexer_skip_whitespace(l);
 
     assert(token->kind > 0);
-    assert(token->location.fileId != 0);
+    assert(token->location.offset != 0);
     assert(token->location.length != 0);
 
+    return true;
+}
+
+static bool laye_token_kind_has_payload(laye_token_kind kind)
+{
+    switch (kind)
+    {
+        case LAYE_TOKEN_BX:
+        case LAYE_TOKEN_IX:
+        case LAYE_TOKEN_UX:
+        case LAYE_TOKEN_FX:
+        case LAYE_TOKEN_LITERAL_INTEGER:
+        case LAYE_TOKEN_LITERAL_STRING:
+            return true;
+
+        default: return false;
+    }
+}
+
+usize laye_token_buffer_count(laye_token_buffer* tokens)
+{
+    assert(tokens != nullptr);
+    return tokens->baseIndex + arrlenu(tokens->kinds);
+}
+
+void laye_token_buffer_push(laye_token_buffer* tokens, laye_token token)
+{
+    assert(tokens != nullptr);
+    assert(token.kind > 0 && token.kind < LAYE_TOKEN_MAX);
+
+    usize tokenIndex = laye_token_buffer_count(tokens);
+    assert(tokenIndex <= UINT32_MAX);
+    arrput(tokens->kinds, cast(u16) token.kind);
+    arrput(tokens->offsets, token.location.offset);
+    arrput(tokens->lengths, token.location.length);
+    tokens->requestedBytes += sizeof(u16) + sizeof(u32) + sizeof(u32);
+
+    if (token.kind == LAYE_TOKEN_IDENTIFIER)
+    {
+        laye_token_symbol symbol = { .tokenIndex = cast(u32) tokenIndex, .symbol = token.symbol };
+        arrput(tokens->symbols, symbol);
+        tokens->requestedBytes += sizeof(laye_token_symbol);
+    }
+    else if (laye_token_kind_has_payload(token.kind))
+    {
+        laye_token_payload payload = { 0 };
+        payload.tokenIndex = cast(u32) tokenIndex;
+        if (token.kind == LAYE_TOKEN_LITERAL_STRING)
+            payload.stringValue = token.stringValue;
+        else if (token.kind == LAYE_TOKEN_LITERAL_INTEGER)
+            payload.integerValue = token.integerValue;
+        else payload.sizeParameter = token.sizeParameter;
+
+        arrput(tokens->payloads, payload);
+        tokens->requestedBytes += sizeof(laye_token_payload);
+    }
+}
+
+laye_token_kind laye_token_buffer_get_kind(laye_token_buffer* tokens, usize index)
+{
+    assert(tokens != nullptr);
+    assert(index >= tokens->baseIndex && index < laye_token_buffer_count(tokens), "token %zu is not in the buffer", index);
+    return cast(laye_token_kind) tokens->kinds[index - tokens->baseIndex];
+}
+
+laye_token laye_token_buffer_get(laye_token_buffer* tokens, usize index)
+{
+    assert(tokens != nullptr);
+    assert(index >= tokens->baseIndex && index < laye_token_buffer_count(tokens), "token %zu is not in the buffer", index);
+
+    usize bufferIndex = index - tokens->baseIndex;
+
+    laye_token token = { 0 };
+    token.kind = cast(laye_token_kind) tokens->kinds[bufferIndex];
+    token.location = (layec_location){
+        .offset = tokens->offsets[bufferIndex],
+        .length = tokens->lengths[bufferIndex],
+    };
+
+    if (token.kind == LAYE_TOKEN_IDENTIFIER)
+    {
+        // symbols are pushed in token order, so they can be binary searched by token index.
+        usize low = 0, high = arrlenu(tokens->symbols);
+        while (low < high)
+        {
+            usize middle = low + (high - low) / 2;
+            if (tokens->symbols[middle].tokenIndex < index)
+                low = middle + 1;
+            else high = middle;
+        }
+
+        assert(low < arrlenu(tokens->symbols) && tokens->symbols[low].tokenIndex == index, "token %zu has no symbol", index);
+        token.symbol = tokens->symbols[low].symbol;
+        return token;
+    }
+
+    if (!laye_token_kind_has_payload(token.kind))
+        return token;
+
+    // payloads are pushed in token order, so they can be binary searched by token index.
+    usize low = 0, high = arrlenu(tokens->payloads);
+    while (low < high)
+    {
+        usize middle = low + (high - low) / 2;
+        if (tokens->payloads[middle].tokenIndex < index)
+            low = middle + 1;
+        else high = middle;
+    }
+
+    assert(low < arrlenu(tokens->payloads) && tokens->payloads[low].tokenIndex == index, "token %zu has no payload", index);
+    laye_token_payload payload = tokens->payloads[low];
+
+    if (token.kind == LAYE_TOKEN_LITERAL_STRING)
+        token.stringValue = payload.stringValue;
+    else if (token.kind == LAYE_TOKEN_LITERAL_INTEGER)
+        token.integerValue = payload.integerValue;
+    else token.sizeParameter = payload.sizeParameter;
+
     return token;
 }
 
-list(laye_token*) laye_lex(layec_context* context, layec_fileid fileId, arena_allocator* tokenArena)
+void laye_token_buffer_discard_before(laye_token_buffer* tokens, usize index)
 {
-    laye_lexer lexer = { 0 };
-    lexer.context = context;
-    lexer.fileId = fileId;
-    lexer.tokenArena = tokenArena;
-    lexer.sourceText = layec_context_get_file_source(context, fileId);
-    
-    utf8_decode_result firstRuneResult = utf8_decode_rune_at_string_position(lexer.sourceText, 0);
-    if (firstRuneResult.kind != UTF8_DECODE_OK)
-        return nullptr;
-    
-    lexer.currentRune = firstRuneResult.value;
-    
-    list(laye_token*) tokens = nullptr;
-    laye_token* token = nullptr;
+    assert(tokens != nullptr);
+    assert(index >= tokens->baseIndex && index <= laye_token_buffer_count(tokens));
+
+    usize discardCount = index - tokens->baseIndex;
+    if (discardCount == 0)
+        return;
+
+    usize keepCount = arrlenu(tokens->kinds) - discardCount;
+    memmove(tokens->kinds, tokens->kinds + discardCount, keepCount * sizeof(u16));
+    memmove(tokens->offsets, tokens->offsets + discardCount, keepCount * sizeof(u32));
+    memmove(tokens->lengths, tokens->lengths + discardCount, keepCount * sizeof(u32));
+    arrsetlen(tokens->kinds, keepCount);
+    arrsetlen(tokens->offsets, keepCount);
+    arrsetlen(tokens->lengths, keepCount);
+
+    usize payloadDiscardCount = 0;
+    while (payloadDiscardCount < arrlenu(tokens->payloads) && tokens->payloads[payloadDiscardCount].tokenIndex < index)
+        payloadDiscardCount++;
+
+    usize symbolDiscardCount = 0;
+    while (symbolDiscardCount < arrlenu(tokens->symbols) && tokens->symbols[symbolDiscardCount].tokenIndex < index)
+        symbolDiscardCount++;
+
+    // stb_ds can't delete from a list which was never allocated.
+    if (payloadDiscardCount > 0)
+        arrdeln(tokens->payloads, 0, payloadDiscardCount);
+    if (symbolDiscardCount > 0)
+        arrdeln(tokens->symbols, 0, symbolDiscardCount);
+    tokens->baseIndex = index;
+}
+
+void laye_token_buffer_destroy(laye_token_buffer* tokens)
+{
+    assert(tokens != nullptr);
+    arrfree(tokens->kinds);
+    arrfree(tokens->offsets);
+    arrfree(tokens->lengths);
+    arrfree(tokens->payloads);
+    arrfree(tokens->symbols);
+}
+
+kos_arena_stats laye_token_buffer_get_stats(laye_token_buffer* tokens)
+{
+    assert(tokens != nullptr);
+
+    // the lists never shrink, so their capacity is the most memory the buffer has held.
+    usize usedBytes = arrlenu(tokens->kinds) * sizeof(u16) + arrlenu(tokens->offsets) * sizeof(u32)
+        + arrlenu(tokens->lengths) * sizeof(u32) + arrlenu(tokens->payloads) * sizeof(laye_token_payload)
+        + arrlenu(tokens->symbols) * sizeof(laye_token_symbol);
+    usize capacityBytes = arrcap(tokens->kinds) * sizeof(u16) + arrcap(tokens->offsets) * sizeof(u32)
+        + arrcap(tokens->lengths) * sizeof(u32) + arrcap(tokens->payloads) * sizeof(laye_token_payload)
+        + arrcap(tokens->symbols) * sizeof(laye_token_symbol);
+
+    return (kos_arena_stats){
+        .pushCount = laye_token_buffer_count(tokens),
+        .requestedBytes = tokens->requestedBytes,
+        .usedBytes = usedBytes,
+        .committedBytes = capacityBytes,
+        .peakCommittedBytes = capacityBytes,
+        .blockCount = 5,
+    };
+}
+
+void laye_lexer_init_tables(void)
+{
+    lexer_build_keyword_table();
+    scan_current_kernel();
+}
+
+void laye_lexer_init(laye_lexer* l, layec_context* context, layec_fileid fileId, arena_allocator* constantArena)
+{
+    assert(l != nullptr);
+    assert(constantArena != nullptr);
+    laye_lexer_init_tables();
+
+    *l = (laye_lexer){ 0 };
+    l->context = context;
+    l->fileId = fileId;
+    l->constantArena = constantArena;
+    l->sourceText = layec_context_get_file_source(context, fileId);
+    l->baseOffset = layec_context_get_file_base_offset(context, fileId);
+
+    // the first byte is read like every other, so a NUL or invalid UTF-8 byte there is reported and skipped too.
+    lexer_set_position(l, 0);
+}
+
+bool laye_lexer_next(laye_lexer* l, laye_token* outToken)
+{
+    assert(l != nullptr);
+    assert(outToken != nullptr);
+
+    *outToken = (laye_token){ 0 };
+    return lexer_get_token(l, outToken);
+}
+
+laye_token_buffer laye_lex(layec_context* context, layec_fileid fileId)
+{
+    layec_timer_scope lexScope;
+    layec_timer_begin(context, &lexScope, "lex", fileId);
+
+    laye_token_buffer tokens = { 0 };
+    tokens.fileId = fileId;
+
+    laye_lexer lexer;
+    laye_lexer_init(&lexer, context, fileId, context->constantArena);
 
-    while ((token = lexer_get_token(&lexer)) != nullptr)
-        arrput(tokens, token);
+    laye_token token;
+    while (laye_lexer_next(&lexer, &token))
+        laye_token_buffer_push(&tokens, token);
 
+    layec_timer_end(context, &lexScope);
     return tokens;
 }
@@ -13,11 +13,27 @@ typedef struct laye_parser
     layec_context* context;
     layec_fileid fileId;
 
-    arena_allocator* tokenArena;
     arena_allocator* astArena;
 
-    laye_token** tokens;
+    // tokens are lexed on demand a batch at a time, `tokens` only holds the ones since the start of the current
+    // top level node and the rest of the batch after it.
+    laye_lexer lexer;
+    laye_token_buffer tokens;
     usize currentTokenIndex;
+    bool isLexerDone;
+
+    // what the lexer reports while lexing ahead is held back until the parser asks for the token it was
+    // reported for, so diagnostics come out in the same order as if every token was lexed on its own.
+    layec_diagnostic_capture lexerDiagnostics;
+    // for each held diagnostic, the index of the token being lexed when it was reported.
+    list(usize) lexerDiagnosticTokenIndices;
+
+    // conditional keywords lex as identifiers, so they're checked against their symbol.
+    layec_symbol asKeyword;
+
+    // lexing is timed a batch at a time when a time report is wanted.
+    bool isTimingLexer;
+    u64 lexNanoseconds;
 } laye_parser;
 
 typedef struct laye_operator_info
@@ -70,13 +86,16 @@ static void* ast_node_allocator(allocator_action action, void* memory, usize cou
     }
 }
 
+// every list in the AST lives in the AST arena, so destroying the arena releases the whole AST.
+#define laye_parser_list_put(p, l, v) (cast(void) ((l) != nullptr || (arena_list_init((p)->astArena, l, 4), true)), arrput(l, v))
+
 static bool laye_parser_is_eof(laye_parser* p);
 static void laye_parser_advance(laye_parser* p);
 static laye_ast_node* laye_parse_top_level(laye_parser* p);
 
 static laye_ast_node* laye_ast_node_alloc(laye_parser* p, laye_ast_node_kind kind, layec_location location)
 {
-    laye_ast_node* result = arena_push(p->astArena, sizeof(laye_ast_node));
+    laye_ast_node* result = arena_push_aligned(p->astArena, laye_ast_node_size(kind), ALIGNOF(laye_ast_node));
     assert(result != nullptr);
     result->kind = kind;
     result->location = location;
@@ -85,7 +104,31 @@ static laye_ast_node* laye_ast_node_alloc(laye_parser* p, laye_ast_node_kind kin
 
 static void laye_parser_read_file_headers(laye_parser *p, laye_ast* ast);
 
-laye_parse_result laye_parse(layec_context* context, layec_fileid fileId)
+// records the lexer's time since it was last recorded, nested in the calling thread's current timer scope.
+static void laye_parser_record_lex_time(laye_parser* p)
+{
+    if (p->lexNanoseconds == 0)
+        return;
+
+    layec_timer_record(p->context, "lex", p->fileId, p->lexNanoseconds);
+    p->lexNanoseconds = 0;
+}
+
+static void laye_parser_destroy_tokens(laye_parser* p)
+{
+    // every way parsing can end destroys the tokens, so whatever lexing is left is recorded here.
+    laye_parser_record_lex_time(p);
+
+    if (p->context->memoryReport)
+        layec_context_record_memory_usage(p->context, "tokens", laye_token_buffer_get_stats(&p->tokens));
+    laye_token_buffer_destroy(&p->tokens);
+
+    // anything still held back was lexed ahead of where parsing stopped, so it's never reported.
+    layec_discard_diagnostics(&p->lexerDiagnostics);
+    arrfree(p->lexerDiagnosticTokenIndices);
+}
+
+laye_parse_result laye_parse(layec_context* context, layec_fileid fileId, arena_allocator* constantArena)
 {
     assert(context != nullptr);
 
@@ -95,13 +138,20 @@ laye_parse_result laye_parse(layec_context* context, layec_fileid fileId)
     laye_parser parser = {
         .context = context,
         .fileId = fileId,
-        .tokenArena = arena_create(default_allocator, 10 * 1024),
-        .astArena = arena_create(default_allocator, 10 * 1024),
+        // only address space is reserved up front, pages are committed as the AST grows.
+        .astArena = arena_create_virtual(default_allocator, 256 * 1024 * 1024),
+        .asKeyword = layec_intern_symbol(context, STRING_VIEW_LITERAL("as")),
+        .isTimingLexer = context->timeReport,
     };
 
-    parser.tokens = laye_lex(context, fileId, parser.tokenArena);
-    if (parser.tokens == nullptr)
+    parser.tokens.fileId = fileId;
+    laye_lexer_init(&parser.lexer, context, fileId, constantArena);
+
+    if (laye_parser_is_eof(&parser))
     {
+        laye_parser_destroy_tokens(&parser);
+        layec_context_record_arena(context, "ast", parser.astArena);
+        arena_destroy(parser.astArena);
         result.status = LAYE_PARSE_FAILURE;
         return result;
     }
@@ -110,17 +160,35 @@ laye_parse_result laye_parse(layec_context* context, layec_fileid fileId)
 
     while (!laye_parser_is_eof(&parser))
     {
+        // the error limit is only checked between top level nodes, so a node is never cut short part way
+        // through its tokens; the rest of the file is skipped without lexing or reporting anything more.
+        if (layec_error_limit_reached(context))
+            break;
+
         usize startIndex = parser.currentTokenIndex;
 
+        // nothing backtracks across a top level node, so every token before it can be dropped.
+        laye_token_buffer_discard_before(&parser.tokens, startIndex);
+
+        layec_timer_scope declarationScope;
+        layec_timer_begin(context, &declarationScope, "parse declaration", fileId);
         laye_ast_node* node = laye_parse_top_level(&parser);
+        laye_parser_record_lex_time(&parser);
+        layec_timer_end(context, &declarationScope);
+
         if (node == nullptr)
         {
+            // the AST's lists live in its arena too, so none of them can be used after this.
+            laye_parser_destroy_tokens(&parser);
+            layec_context_record_arena(context, "ast", parser.astArena);
+            arena_destroy(parser.astArena);
+            result.ast = (laye_ast){ .fileId = fileId };
             result.status = LAYE_PARSE_FAILURE;
             return result;
         }
 
         assert(node != nullptr);
-        arrput(result.ast.topLevelNodes, node);
+        laye_parser_list_put(&parser, result.ast.topLevelNodes, node);
 
         if (startIndex == parser.currentTokenIndex)
         {
@@ -129,17 +197,83 @@ laye_parse_result laye_parse(layec_context* context, layec_fileid fileId)
         }
     }
 
-    arena_destroy(parser.tokenArena);
-    parser.tokenArena = nullptr;
+    laye_parser_destroy_tokens(&parser);
+
+    // a file cut short by the error limit has an incomplete tree, so it fails like a file with a fatal error.
+    if (layec_error_limit_reached(context))
+    {
+        layec_context_record_arena(context, "ast", parser.astArena);
+        arena_destroy(parser.astArena);
+        result.ast = (laye_ast){ .fileId = fileId };
+        result.status = LAYE_PARSE_FAILURE;
+        return result;
+    }
 
     result.astArena = parser.astArena;
     return result;
 }
 
+#define LAYE_PARSER_LEX_BATCH_COUNT 64
+
+// lexes the next batch of tokens into the buffer, holding back whatever the lexer reports on the way.
+static void laye_parser_lex_batch(laye_parser* p)
+{
+    assert(p != nullptr);
+    assert(!p->isLexerDone);
+
+    layec_diagnostic_capture* outerCapture = layec_get_diagnostic_capture();
+    layec_set_diagnostic_capture(&p->lexerDiagnostics);
+
+    u64 lexStartNanoseconds = p->isTimingLexer ? platform_monotonic_nanoseconds() : 0;
+
+    laye_token token;
+    for (usize i = 0; i < LAYE_PARSER_LEX_BATCH_COUNT && !p->isLexerDone; i++)
+    {
+        usize diagnosticCountBefore = arrlenu(p->lexerDiagnostics.diagnostics);
+        bool hasToken = laye_lexer_next(&p->lexer, &token);
+
+        usize tokenIndex = laye_token_buffer_count(&p->tokens);
+        for (usize j = diagnosticCountBefore; j < arrlenu(p->lexerDiagnostics.diagnostics); j++)
+            arrput(p->lexerDiagnosticTokenIndices, tokenIndex);
+
+        if (hasToken)
+            laye_token_buffer_push(&p->tokens, token);
+        else p->isLexerDone = true;
+    }
+
+    if (p->isTimingLexer)
+        p->lexNanoseconds += platform_monotonic_nanoseconds() - lexStartNanoseconds;
+
+    layec_set_diagnostic_capture(outerCapture);
+}
+
+// lexes tokens until the token at `index` is buffered, returns false if the file has no token at `index`.
+static bool laye_parser_ensure_token(laye_parser* p, usize index)
+{
+    assert(p != nullptr);
+
+    while (index >= laye_token_buffer_count(&p->tokens) && !p->isLexerDone)
+        laye_parser_lex_batch(p);
+
+    // the diagnostics for every token up to `index` are reported now, when lexing one token at a time would have.
+    usize releasedCount = 0;
+    usize heldCount = arrlenu(p->lexerDiagnosticTokenIndices);
+    while (releasedCount < heldCount && p->lexerDiagnosticTokenIndices[releasedCount] <= index)
+        releasedCount++;
+
+    if (releasedCount != 0)
+    {
+        layec_replay_diagnostics_prefix(p->context, &p->lexerDiagnostics, releasedCount);
+        arrdeln(p->lexerDiagnosticTokenIndices, 0, releasedCount);
+    }
+
+    return index < laye_token_buffer_count(&p->tokens);
+}
+
 static bool laye_parser_is_eof(laye_parser* p)
 {
     assert(p != nullptr);
-    return p->currentTokenIndex >= arrlenu(p->tokens);
+    return !laye_parser_ensure_token(p, p->currentTokenIndex);
 }
 
 static laye_ast_node* laye_parse_declaration_or_statement(laye_parser* p);
@@ -160,22 +294,33 @@ static void laye_parser_advance(laye_parser* p)
     p->currentTokenIndex++;
 }
 
-static laye_token* laye_parser_current(laye_parser* p)
+static laye_token laye_parser_current(laye_parser* p)
+{
+    assert(p != nullptr);
+    bool hasCurrentToken = laye_parser_ensure_token(p, p->currentTokenIndex);
+    assert(hasCurrentToken);
+    return laye_token_buffer_get(&p->tokens, p->currentTokenIndex);
+}
+
+// interns the text of a location in the file being parsed, reading it straight from the lexer's source.
+// identifier tokens already carry their symbol, this is for names made of any other tokens.
+static layec_symbol laye_parser_intern_location_symbol(laye_parser* p, layec_location location)
 {
     assert(p != nullptr);
-    assert(p->currentTokenIndex < arrlenu(p->tokens));
+    assert(location.offset >= p->lexer.baseOffset);
+
+    usize sourceOffset = location.offset - p->lexer.baseOffset;
+    assert(sourceOffset + location.length <= p->lexer.sourceText.count);
 
-    laye_token* resultToken = p->tokens[p->currentTokenIndex];
-    assert(resultToken);
-    return resultToken;
+    string_view text = { p->lexer.sourceText.memory + sourceOffset, location.length };
+    return layec_intern_symbol(p->context, text);
 }
 
 static layec_location laye_parser_eof_location(laye_parser* p)
 {
     assert(p != nullptr);
 
-    string fileSource = layec_context_get_file_source(p->context, p->fileId);
-    return (layec_location){ .fileId = p->fileId, .offset = fileSource.count, .length = 0 };
+    return (layec_location){ .offset = p->lexer.baseOffset + cast(u32) p->lexer.sourceText.count, .length = 0 };
 }
 
 static layec_location laye_parser_most_recent_location(laye_parser* p)
@@ -183,10 +328,9 @@ static layec_location laye_parser_most_recent_location(laye_parser* p)
     if (laye_parser_is_eof(p))
         return laye_parser_eof_location(p);
     
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
-    return current->location;
+    return current.location;
 }
 
 static bool laye_parser_check(laye_parser* p, laye_token_kind kind)
@@ -194,41 +338,27 @@ static bool laye_parser_check(laye_parser* p, laye_token_kind kind)
     assert(p != nullptr);
     if (laye_parser_is_eof(p)) return false;
     
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
-
-    return current->kind == kind;
+    return laye_token_buffer_get_kind(&p->tokens, p->currentTokenIndex) == kind;
 }
 
-static bool laye_parser_check_conditional_keyword(laye_parser* p, const char* keyword)
+static bool laye_parser_check_conditional_keyword(laye_parser* p, layec_symbol keyword)
 {
     assert(p != nullptr);
+    if (!laye_parser_check(p, LAYE_TOKEN_IDENTIFIER)) return false;
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
-
-    if (current->kind != LAYE_TOKEN_IDENTIFIER || strlen(keyword) != current->location.length)
-    {
-        return false;
-    }
-
-    string sourceText = layec_context_get_file_source(p->context, current->location.fileId);
-    return 0 == strncmp(keyword, cast(const char*) (sourceText.memory + current->location.offset), current->location.length);
+    return laye_parser_current(p).symbol == keyword;
 }
 
 static bool laye_parser_peek_check(laye_parser* p, laye_token_kind kind)
 {
     assert(p != nullptr);
-    if (p->currentTokenIndex + 1 >= arrlenu(p->tokens))
+    if (!laye_parser_ensure_token(p, p->currentTokenIndex + 1))
         return false;
-    
-    laye_token* current = p->tokens[p->currentTokenIndex + 1];
-    assert(current != nullptr);
 
-    return current->kind == kind;
+    return laye_token_buffer_get_kind(&p->tokens, p->currentTokenIndex + 1) == kind;
 }
 
-static void laye_parser_expect_out(laye_parser* p, laye_token_kind kind, const char* fmt, laye_token** outToken)
+static void laye_parser_expect_out(laye_parser* p, laye_token_kind kind, const char* fmt, laye_token* outToken)
 {
     assert(p != nullptr);
     
@@ -244,36 +374,33 @@ static void laye_parser_expect_out(laye_parser* p, laye_token_kind kind, const c
 
         if (outToken != nullptr)
         {
-            laye_token* newToken = arena_push(p->tokenArena, sizeof(laye_token));
-            newToken->kind = kind;
-            newToken->location = endLocation;
-
-            *outToken = newToken;
+            *outToken = (laye_token){
+                .kind = kind,
+                .location = endLocation,
+            };
         }
 
         return;
     }
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
-    if (current->kind != kind)
+    if (current.kind != kind)
     {
         if (fmt == nullptr)
         {
             fmt = "'%c' expected.";
         }
 
-        layec_issue_diagnostic(p->context, SEV_ERROR, current->location, fmt, cast(char) kind);
+        layec_issue_diagnostic(p->context, SEV_ERROR, current.location, fmt, cast(char) kind);
         
         if (outToken != nullptr)
         {
-            laye_token* newToken = arena_push(p->tokenArena, sizeof(laye_token));
-            newToken->kind = kind;
-            newToken->location = current->location;
-            newToken->location.length = 0;
-
-            *outToken = newToken;
+            *outToken = (laye_token){
+                .kind = kind,
+                .location = current.location,
+            };
+            outToken->location.length = 0;
         }
 
         return;
@@ -292,9 +419,9 @@ static void laye_parser_expect(laye_parser* p, laye_token_kind kind, const char*
     laye_parser_expect_out(p, kind, fmt, nullptr);
 }
 
-static laye_token* laye_parser_expect_identifier(laye_parser* p, const char* fmt)
+static laye_token laye_parser_expect_identifier(laye_parser* p, const char* fmt)
 {
-    laye_token* identifierToken = nullptr;
+    laye_token identifierToken = { 0 };
     if (fmt == nullptr)
         fmt = "Identifier expected.";
     laye_parser_expect_out(p, LAYE_TOKEN_IDENTIFIER, fmt, &identifierToken);
@@ -305,12 +432,11 @@ static laye_ast_import laye_parse_import_declaration(laye_parser* p, bool export
 {
     assert(p != nullptr);
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
-    assert(current->kind == LAYE_TOKEN_IMPORT);
+    laye_token current = laye_parser_current(p);
+    assert(current.kind == LAYE_TOKEN_IMPORT);
 
     laye_ast_import result = { 0 };
-    result.location = current->location;
+    result.location = current.location;
     result.export = export;
 
     laye_parser_advance(p);
@@ -318,25 +444,22 @@ static laye_ast_import laye_parse_import_declaration(laye_parser* p, bool export
     if (laye_parser_check(p, LAYE_TOKEN_IDENTIFIER))
     {
         current = laye_parser_current(p);
-        assert(current != nullptr);
-        result.name = layec_intern_location_text(p->context, current->location);
+        result.name = current.symbol;
         laye_parser_advance(p);
     }
     else
     {
-        laye_token* stringToken = nullptr;
+        laye_token stringToken = { 0 };
         laye_parser_expect_out(p, LAYE_TOKEN_LITERAL_STRING, "String literal expected as import library or file name.", &stringToken);
-        assert(stringToken != nullptr);
-        assert(stringToken->stringValue.count > 0);
-        result.name = layec_intern_string_view(p->context, string_slice(stringToken->stringValue, 0, stringToken->stringValue.count));
+        assert(stringToken.stringValue.count > 0);
+        result.name = layec_intern_symbol(p->context, string_slice(stringToken.stringValue, 0, stringToken.stringValue.count));
     }
 
-    if (laye_parser_check_conditional_keyword(p, "as"))
+    if (laye_parser_check_conditional_keyword(p, p->asKeyword))
     {
         laye_parser_advance(p);
-        laye_token* aliasToken = laye_parser_expect_identifier(p, nullptr);
-        assert(aliasToken != nullptr);
-        result.alias = layec_intern_location_text(p->context, aliasToken->location);
+        laye_token aliasToken = laye_parser_expect_identifier(p, nullptr);
+        result.alias = aliasToken.symbol;
     }
 
     laye_parser_expect(p, ';', nullptr);
@@ -356,15 +479,14 @@ static void laye_parser_read_file_headers(laye_parser *p, laye_ast* ast)
             laye_parser_advance(p);
         }
 
-        laye_token* current = laye_parser_current(p);
-        assert(current != nullptr);
+        laye_token current = laye_parser_current(p);
 
-        switch (current->kind)
+        switch (current.kind)
         {
             case LAYE_TOKEN_IMPORT:
             {
                 laye_ast_import importData = laye_parse_import_declaration(p, isExport);
-                arrput(ast->imports, importData);
+                laye_parser_list_put(p, ast->imports, importData);
             } continue;
 
             default:
@@ -383,9 +505,8 @@ static list(laye_ast_template_argument) laye_parse_template_arguments(laye_parse
 {
     assert(p != nullptr);
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
-    assert(current->kind == '<', "when calling laye_parse_template_arguments, the current token must be '<'");
+    laye_token current = laye_parser_current(p);
+    assert(current.kind == '<', "when calling laye_parse_template_arguments, the current token must be '<'");
 
     list(laye_ast_template_argument) result = nullptr;
 
@@ -402,7 +523,7 @@ static list(laye_ast_template_argument) laye_parse_template_arguments(laye_parse
                 .kind = LAYE_TEMPLATE_ARG_TYPE,
                 .value = maybeTypeNode,
             };
-            arrput(result, arg);
+            laye_parser_list_put(p, result, arg);
         }
         else
         {
@@ -412,7 +533,7 @@ static list(laye_ast_template_argument) laye_parse_template_arguments(laye_parse
                 .kind = LAYE_TEMPLATE_ARG_VALUE,
                 .value = expression,
             };
-            arrput(result, arg);
+            laye_parser_list_put(p, result, arg);
         }
 
         if (!laye_parser_check(p, ','))
@@ -422,16 +543,16 @@ static list(laye_ast_template_argument) laye_parse_template_arguments(laye_parse
         if (!laye_parser_check(p, '>'))
             continue;
 
-        layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p)->location, "Type parameter expected");
+        layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p).location, "Type parameter expected");
         break;
     }
 
-    laye_token* closingToken = nullptr;
+    laye_token closingToken = { 0 };
     laye_parser_expect_out(p, '>', nullptr, &closingToken);
 
     if (arrlenu(result) == 0)
     {
-        layec_issue_diagnostic(p->context, SEV_ERROR, closingToken->location, "Template argument lists cannot be empty");
+        layec_issue_diagnostic(p->context, SEV_ERROR, closingToken.location, "Template argument lists cannot be empty");
     }
 
     return result;
@@ -451,10 +572,9 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
     if (laye_parser_is_eof(p))
         return true;
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
     
-    layec_location startLocation = current->location;
+    layec_location startLocation = current.location;
 
     laye_ast_type_access access = LAYE_AST_ACCESS_NONE;
     if (laye_parser_check(p, LAYE_TOKEN_READONLY))
@@ -469,11 +589,11 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
     }
 
     bool isNilable = false;
-    switch (current->kind)
+    switch (current.kind)
     {
         case '*':
         {
-            layec_location typeLocation = layec_location_combine(startLocation, current->location);
+            layec_location typeLocation = layec_location_combine(startLocation, current.location);
             laye_parser_advance(p);
 
             if (laye_parser_check(p, '?'))
@@ -510,7 +630,7 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
                         isNilable = true;
                     }
                     
-                    layec_location typeLocation = layec_location_combine(startLocation, current->location);
+                    layec_location typeLocation = layec_location_combine(startLocation, current.location);
                     laye_ast_node* newType = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_BUFFER, typeLocation);
                     newType->containerType.elementType = *typeSyntax;
                     newType->containerType.access = access;
@@ -525,7 +645,7 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
                     {
                         laye_ast_node* rank = laye_parse_expression(p);
                         assert(rank != nullptr);
-                        arrput(ranks, rank);
+                        laye_parser_list_put(p, ranks, rank);
 
                         if (!laye_parser_check(p, ','))
                             break;
@@ -554,7 +674,7 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
                         isNilable = true;
                     }
 
-                    layec_location typeLocation = layec_location_combine(startLocation, current->location);
+                    layec_location typeLocation = layec_location_combine(startLocation, current.location);
                     laye_ast_node* newType = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_ARRAY, typeLocation);
                     newType->containerType.elementType = *typeSyntax;
                     newType->containerType.ranks = ranks;
@@ -584,7 +704,7 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
                 isNilable = true;
             }
 
-            layec_location typeLocation = layec_location_combine(startLocation, current->location);
+            layec_location typeLocation = layec_location_combine(startLocation, current.location);
             laye_ast_node* newType = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_SLICE, typeLocation);
             newType->containerType.elementType = *typeSyntax;
             newType->containerType.access = access;
@@ -638,12 +758,13 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
 
                 if (!issueDiagnostics && !success)
                 {
+                    arrfree(parameterTypes);
                     p->currentTokenIndex = startIndex;
                     return false;
                 }
                 // else assume we already issued sufficient diagnostics
 
-                arrput(parameterTypes, parameterType);
+                laye_parser_list_put(p, parameterTypes, parameterType);
 
                 if (!laye_parser_check(p, ','))
                     break;
@@ -652,7 +773,7 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
                 if (!laye_parser_check(p, ')'))
                     continue;
 
-                layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p)->location, "Expected parameter.");
+                layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p).location, "Expected parameter.");
                 break;
             }
 
@@ -665,7 +786,7 @@ static bool laye_parser_try_parse_type_suffix(laye_parser* p, usize startIndex,
                 isNilable = true;
             }
 
-            layec_location typeLocation = layec_location_combine(startLocation, current->location);
+            layec_location typeLocation = layec_location_combine(startLocation, current.location);
             laye_ast_node* newType = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_FUNCTION, typeLocation);
             newType->functionType.returnType = *typeSyntax;
             newType->functionType.parameterTypes = parameterTypes;
@@ -704,10 +825,9 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
 
     usize startIndex = p->currentTokenIndex;
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
-    layec_location startLocation = current->location;
+    layec_location startLocation = current.location;
 
     if (laye_parser_is_eof(p))
     {
@@ -758,17 +878,16 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
     }
 
     current = laye_parser_current(p);
-    assert(current != nullptr);
 
     #define WORD_TYPE(TK, TY, SX) \
         case LAYE_TOKEN_ ## TK: \
         { \
-            laye_ast_node* type = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_ ## TY, current->location); \
+            laye_ast_node* type = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_ ## TY, current.location); \
             if (access != LAYE_AST_ACCESS_NONE && LAYE_TOKEN_ ## TK != LAYE_TOKEN_STRING && LAYE_TOKEN_ ## TK != LAYE_TOKEN_C_STRING) \
             { \
-                layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Type cannot be readonly/writeonly."); \
+                layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Type cannot be readonly/writeonly."); \
             } else type->primitiveType.access = access; \
-            if (SX) type->primitiveType.size = current->sizeParameter; \
+            if (SX) type->primitiveType.size = current.sizeParameter; \
             laye_parser_advance(p); \
             if (laye_parser_check(p, '?')) { \
                 laye_parser_advance(p); \
@@ -778,11 +897,11 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
             return laye_parser_try_parse_type_suffix(p, startIndex, outTypeSyntax, issueDiagnostics, allowFunctions); \
         }
 
-    list(string) path = nullptr;
-    string identifierName = { 0 };
+    list(layec_symbol) path = nullptr;
+    layec_symbol identifierName = 0;
     bool isPathHeadless = false;
     bool isPathGlobal = false;
-    switch (current->kind)
+    switch (current.kind)
     {
         case LAYE_TOKEN_GLOBAL:
             isPathGlobal = true;
@@ -791,8 +910,8 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
             {
                 if (issueDiagnostics)
                 {
-                    layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Expected '::'.");
-                    return laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_INVALID, current->location);
+                    layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Expected '::'.");
+                    return laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_INVALID, current.location);
                 }
 
                 p->currentTokenIndex = startIndex;
@@ -804,9 +923,9 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
             goto start_path_resolution_parse;
         case LAYE_TOKEN_IDENTIFIER:
         {
-            identifierName = layec_intern_location_text(p->context, current->location);
+            identifierName = current.symbol;
             laye_parser_advance(p);
-            arrput(path, identifierName);
+            laye_parser_list_put(p, path, identifierName);
             
             if (laye_parser_check(p, LAYE_TOKEN_COLON_COLON))
             {
@@ -815,17 +934,16 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
                 while (laye_parser_check(p, LAYE_TOKEN_COLON_COLON))
                 {
                     laye_parser_advance(p);
-                    laye_token* nextIdent = laye_parser_expect_identifier(p, nullptr);
-                    assert(nextIdent != nullptr);
-                    lastIdentifierLocation = nextIdent->location;
-                    string nextName = layec_intern_location_text(p->context, nextIdent->location);
-                    startLocation = layec_location_combine(startLocation, nextIdent->location);
-                    arrput(path, nextName);
+                    laye_token nextIdent = laye_parser_expect_identifier(p, nullptr);
+                    lastIdentifierLocation = nextIdent.location;
+                    layec_symbol nextName = nextIdent.symbol;
+                    startLocation = layec_location_combine(startLocation, nextIdent.location);
+                    laye_parser_list_put(p, path, nextName);
                 }
             }
 
             list(laye_ast_template_argument) templateArguments = nullptr;
-            if (laye_parser_check(p, '<') && layec_location_immediately_follows(current->location, laye_parser_current(p)->location))
+            if (laye_parser_check(p, '<') && layec_location_immediately_follows(current.location, laye_parser_current(p).location))
             {
                 templateArguments = laye_parse_template_arguments(p);
             }
@@ -908,8 +1026,8 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
         {
             if (issueDiagnostics)
             {
-                layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Identifier expected when parsing a type.");
-                *outTypeSyntax = laye_ast_node_alloc(p, LAYE_AST_NODE_INVALID, current->location);
+                layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Identifier expected when parsing a type.");
+                *outTypeSyntax = laye_ast_node_alloc(p, LAYE_AST_NODE_INVALID, current.location);
                 laye_parser_advance(p);
                 return true;
             }
@@ -927,7 +1045,14 @@ static bool laye_parser_try_parse_type_impl(laye_parser* p, laye_ast_node** outT
 /// @return True if outTypeSyntax has been populated with a type syntax node, false otherwise.
 static bool laye_parser_try_parse_type(laye_parser* p, laye_ast_node** outTypeSyntax, bool issueDiagnostics)
 {
-    return laye_parser_try_parse_type_impl(p, outTypeSyntax, issueDiagnostics, true);
+    // nothing allocated by a failed speculative parse is referenced afterwards, so it's released right away.
+    arena_marker marker = arena_mark(p->astArena);
+
+    bool success = laye_parser_try_parse_type_impl(p, outTypeSyntax, issueDiagnostics, true);
+    if (!success && !issueDiagnostics)
+        arena_rewind(p->astArena, marker);
+
+    return success;
 }
 
 static laye_ast_node* laye_parse_statement(laye_parser* p);
@@ -940,10 +1065,9 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
     if (laye_parser_is_eof(p))
         return expression;
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
-    switch (current->kind)
+    switch (current.kind)
     {
         default: break;
 
@@ -958,7 +1082,7 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
                 endsWithComma = false;
                 if (laye_parser_check(p, ','))
                 {
-                    layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p)->location, "Type expected as function type parameter.");
+                    layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p).location, "Type expected as function type parameter.");
                     laye_parser_advance(p);
                     continue;
                 }
@@ -966,7 +1090,7 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
                 laye_ast_node* argument = laye_parse_expression(p);
                 assert(argument != nullptr);
 
-                arrput(argumentNodes, argument);
+                laye_parser_list_put(p, argumentNodes, argument);
 
                 if (!laye_parser_check(p, ','))
                     break;
@@ -979,7 +1103,7 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
 
             if (endsWithComma)
             {
-                layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Expression expected as invocation argument.");
+                layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Expression expected as invocation argument.");
             }
 
             layec_location location = layec_location_combine(expression->location, laye_parser_most_recent_location(p));
@@ -1036,14 +1160,14 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
             }
 
             list(laye_ast_node*) indexArguments = nullptr;
-            arrput(indexArguments, firstExpression);
+            laye_parser_list_put(p, indexArguments, firstExpression);
 
             if (laye_parser_check(p, ','))
             {
                 laye_parser_advance(p);
                 if (laye_parser_check(p, ']'))
                 {
-                    layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p)->location, "Expression expected");
+                    layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p).location, "Expression expected");
                 }
                 else
                 {
@@ -1051,7 +1175,7 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
                     {
                         laye_ast_node* arg = laye_parse_expression(p);
                         assert(arg != nullptr);
-                        arrput(indexArguments, arg);
+                        laye_parser_list_put(p, indexArguments, arg);
 
                         if (!laye_parser_check(p, ','))
                             break;
@@ -1060,7 +1184,7 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
                         if (!laye_parser_check(p, ']'))
                             continue;
 
-                        layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p)->location, "Expression expected");
+                        layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p).location, "Expression expected");
                         break;
                     }
                     while (!laye_parser_is_eof(p) && !laye_parser_check(p, ']'));
@@ -1079,8 +1203,8 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
         case '.':
         {
             laye_parser_advance(p);
-            laye_token* nameToken = laye_parser_expect_identifier(p, nullptr);
-            string name = layec_intern_location_text(p->context, nameToken->location);
+            laye_token nameToken = laye_parser_expect_identifier(p, nullptr);
+            layec_symbol name = nameToken.symbol;
             
             laye_ast_node* sliceExpression = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_FIELD_INDEX, expression->location);
             sliceExpression->field_index.target = expression;
@@ -1091,22 +1215,22 @@ static laye_ast_node* laye_parse_primary_suffix(laye_parser* p, laye_ast_node* e
 
         case LAYE_TOKEN_CATCH:
         {
-            layec_location startLocation = current->location;
+            layec_location startLocation = current.location;
             laye_parser_advance(p);
 
-            string captureName = { 0 };
+            layec_symbol captureName = 0;
             if (laye_parser_check(p, '('))
             {
                 laye_parser_advance(p);
-                laye_token* captureNameToken = laye_parser_expect_identifier(p, nullptr);
-                captureName = layec_intern_location_text(p->context, captureNameToken->location);
+                laye_token captureNameToken = laye_parser_expect_identifier(p, nullptr);
+                captureName = captureNameToken.symbol;
                 laye_parser_expect(p, ')', nullptr);
             }
 
             laye_ast_node* body = laye_parse_statement(p);
             assert(body != nullptr);
 
-            if (p->tokens[p->currentTokenIndex - 1]->kind == ';')
+            if (laye_token_buffer_get_kind(&p->tokens, p->currentTokenIndex - 1) == ';')
             {
                 p->currentTokenIndex--;
             }
@@ -1133,8 +1257,8 @@ static list(laye_ast_constructor_value) laye_parse_constructor(laye_parser* p, l
     list(laye_ast_constructor_value) values = nullptr;
     while (!laye_parser_is_eof(p) && !laye_parser_check(p, '}'))
     {
-        laye_token* valueNameToken = laye_parser_expect_identifier(p, nullptr);
-        string valueName = layec_intern_location_text(p->context, valueNameToken->location);
+        laye_token valueNameToken = laye_parser_expect_identifier(p, nullptr);
+        layec_symbol valueName = valueNameToken.symbol;
 
         laye_parser_expect(p, '=', nullptr);
 
@@ -1144,7 +1268,7 @@ static list(laye_ast_constructor_value) laye_parse_constructor(laye_parser* p, l
             .name = valueName,
             .value = value,
         };
-        arrput(values, ctorValue);
+        laye_parser_list_put(p, values, ctorValue);
 
         if (!laye_parser_check(p, ','))
             break;
@@ -1152,11 +1276,10 @@ static list(laye_ast_constructor_value) laye_parse_constructor(laye_parser* p, l
         laye_parser_advance(p);
     }
 
-    laye_token* lastToken = nullptr;
+    laye_token lastToken = { 0 };
     laye_parser_expect_out(p, '}', nullptr, &lastToken);
-    assert(lastToken != nullptr);
 
-    if (lastLocation) *lastLocation = lastToken->location;
+    if (lastLocation) *lastLocation = lastToken.location;
     return values;
 }
 
@@ -1168,10 +1291,9 @@ static laye_ast_node* laye_parse_identifier_suffix(laye_parser* p, laye_ast_node
     if (laye_parser_is_eof(p))
         return expression;
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
-    switch (current->kind)
+    switch (current.kind)
     {
         default: break;
 
@@ -1180,7 +1302,7 @@ static laye_ast_node* laye_parse_identifier_suffix(laye_parser* p, laye_ast_node
             layec_location lastLocation = { 0 };
             list(laye_ast_constructor_value) values = laye_parse_constructor(p, &lastLocation);
 
-            list(string) path = expression->lookup.path;
+            list(layec_symbol) path = expression->lookup.path;
             bool isHeadless = expression->lookup.isHeadless;
             list(laye_ast_template_argument) templateArguments = expression->lookup.templateArguments;
 
@@ -1212,23 +1334,22 @@ static laye_ast_node* laye_parse_primary(laye_parser* p)
         return laye_ast_node_alloc(p, LAYE_AST_NODE_INVALID, endLocation);
     }
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
-    layec_location startLocation = current->location;
+    laye_token current = laye_parser_current(p);
+    layec_location startLocation = current.location;
 
-    list(string) path = nullptr;
-    string identifierName = { 0 };
+    list(layec_symbol) path = nullptr;
+    layec_symbol identifierName = 0;
     bool isPathHeadless = false;
     bool isPathGlobal = false;
-    switch (current->kind)
+    switch (current.kind)
     {
         case LAYE_TOKEN_GLOBAL:
             isPathGlobal = true;
             laye_parser_advance(p);
             if (!laye_parser_check(p, LAYE_TOKEN_COLON_COLON))
             {
-                layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Expected '::'.");
-                return laye_ast_node_alloc(p, LAYE_AST_NODE_INVALID, current->location);
+                layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Expected '::'.");
+                return laye_ast_node_alloc(p, LAYE_AST_NODE_INVALID, current.location);
             }
             goto start_path_resolution_parse;
         case LAYE_TOKEN_COLON_COLON:
@@ -1236,9 +1357,9 @@ static laye_ast_node* laye_parse_primary(laye_parser* p)
             goto start_path_resolution_parse;
         case LAYE_TOKEN_IDENTIFIER:
         {
-            identifierName = layec_intern_location_text(p->context, current->location);
+            identifierName = current.symbol;
             laye_parser_advance(p);
-            arrput(path, identifierName);
+            laye_parser_list_put(p, path, identifierName);
 
             if (laye_parser_check(p, LAYE_TOKEN_COLON_COLON))
             {
@@ -1247,17 +1368,16 @@ static laye_ast_node* laye_parse_primary(laye_parser* p)
                 while (laye_parser_check(p, LAYE_TOKEN_COLON_COLON))
                 {
                     laye_parser_advance(p);
-                    laye_token* nextIdent = laye_parser_expect_identifier(p, nullptr);
-                    assert(nextIdent != nullptr);
-                    lastIdentifierLocation = nextIdent->location;
-                    string nextName = layec_intern_location_text(p->context, nextIdent->location);
-                    startLocation = layec_location_combine(startLocation, nextIdent->location);
-                    arrput(path, nextName);
+                    laye_token nextIdent = laye_parser_expect_identifier(p, nullptr);
+                    lastIdentifierLocation = nextIdent.location;
+                    layec_symbol nextName = nextIdent.symbol;
+                    startLocation = layec_location_combine(startLocation, nextIdent.location);
+                    laye_parser_list_put(p, path, nextName);
                 }
             }
 
             list(laye_ast_template_argument) templateArguments = nullptr;
-            if (laye_parser_check(p, '<') && layec_location_immediately_follows(current->location, laye_parser_current(p)->location))
+            if (laye_parser_check(p, '<') && layec_location_immediately_follows(current.location, laye_parser_current(p).location))
             {
                 templateArguments = laye_parse_template_arguments(p);
             }
@@ -1273,7 +1393,7 @@ static laye_ast_node* laye_parse_primary(laye_parser* p)
 
         case LAYE_TOKEN_TRY:
         {
-            layec_location startLocation = current->location;
+            layec_location startLocation = current.location;
             laye_parser_advance(p);
 
             laye_ast_node* thingToTry = laye_parse_primary(p);
@@ -1286,7 +1406,7 @@ static laye_ast_node* laye_parse_primary(laye_parser* p)
 
         case LAYE_TOKEN_NEW:
         {
-            layec_location startLocation = current->location;
+            layec_location startLocation = current.location;
             laye_parser_advance(p);
 
             laye_ast_node* allocator = nullptr;
@@ -1321,18 +1441,18 @@ static laye_ast_node* laye_parse_primary(laye_parser* p)
 
         case LAYE_TOKEN_LITERAL_STRING:
         {
-            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_STRING, current->location);
+            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_STRING, current.location);
             assert(resultNode != nullptr);
-            resultNode->literal.stringValue = current->stringValue;
+            resultNode->literal.stringValue = current.stringValue;
             laye_parser_advance(p);
             return laye_parse_primary_suffix(p, resultNode);
         }
 
         case LAYE_TOKEN_LITERAL_INTEGER:
         {
-            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_INTEGER, current->location);
+            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_INTEGER, current.location);
             assert(resultNode != nullptr);
-            resultNode->literal.integerValue = current->integerValue;
+            resultNode->literal.integerValue = current.integerValue;
             laye_parser_advance(p);
             return laye_parse_primary_suffix(p, resultNode);
         }
@@ -1340,32 +1460,33 @@ static laye_ast_node* laye_parse_primary(laye_parser* p)
         case LAYE_TOKEN_TRUE:
         case LAYE_TOKEN_FALSE:
         {
-            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_BOOL, current->location);
+            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_BOOL, current.location);
             assert(resultNode != nullptr);
-            resultNode->literal.boolValue = current->kind == LAYE_TOKEN_TRUE;
+            resultNode->literal.boolValue = current.kind == LAYE_TOKEN_TRUE;
             laye_parser_advance(p);
             return laye_parse_primary_suffix(p, resultNode);
         }
 
         default:
         {
-            layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Unexpected token when parsing expression.");
+            layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Unexpected token when parsing expression.");
             laye_parser_advance(p);
-            return laye_ast_node_alloc(p, LAYE_AST_NODE_INVALID, current->location);
+            return laye_ast_node_alloc(p, LAYE_AST_NODE_INVALID, current.location);
         }
     }
 }
 
 static bool is_binary_operator_with_precedence(laye_parser* p, int precedence, int* outNewPrecedence)
 {
-    laye_token* c = laye_parser_current(p);
-    if (c == NULL)
+    if (laye_parser_is_eof(p))
         return false;
 
+    laye_token_kind kind = laye_token_buffer_get_kind(&p->tokens, p->currentTokenIndex);
+
     usize numOps = sizeof(layeOperatorInfos) / sizeof(laye_operator_info);
     for (usize i = 0; i < numOps; i++)
     {
-        if (c->kind == layeOperatorInfos[i].tokenKind && layeOperatorInfos[i].precendence >= precedence)
+        if (kind == layeOperatorInfos[i].tokenKind && layeOperatorInfos[i].precendence >= precedence)
         {
             if (outNewPrecedence)
                 *outNewPrecedence = layeOperatorInfos[i].precendence;
@@ -1385,8 +1506,7 @@ static laye_ast_node* laye_parse_binary(laye_parser* p, laye_ast_node* lhs, int
     int nextPrecedence = 0;
     while (is_binary_operator_with_precedence(p, precedence, &nextPrecedence))
     {
-        laye_token* operatorToken = laye_parser_current(p);
-        assert(operatorToken != nullptr);
+        laye_token operatorToken = laye_parser_current(p);
         laye_parser_advance(p);
 
         laye_ast_node* rhs = laye_parse_primary(p);
@@ -1399,8 +1519,8 @@ static laye_ast_node* laye_parse_binary(laye_parser* p, laye_ast_node* lhs, int
         laye_ast_node* binaryExpression = laye_ast_node_alloc(p, LAYE_AST_NODE_EXPRESSION_BINARY, layec_location_combine(lhs->location, rhs->location));
         binaryExpression->binary.lhs = lhs;
         binaryExpression->binary.rhs = rhs;
-        binaryExpression->binary.operatorKind = operatorToken->kind;
-        binaryExpression->binary.operatorString = layec_intern_location_text(p->context, operatorToken->location);
+        binaryExpression->binary.operatorKind = operatorToken.kind;
+        binaryExpression->binary.operatorString = laye_parser_intern_location_symbol(p, operatorToken.location);
 
         lhs = binaryExpression;
     }
@@ -1434,7 +1554,7 @@ static laye_ast_node* laye_parse_grouped_statement(laye_parser* p)
     assert(p != nullptr);
     assert(laye_parser_check(p, '{'));
 
-    laye_token* firstToken = laye_parser_current(p);
+    laye_token firstToken = laye_parser_current(p);
     laye_parser_advance(p);
 
     list(laye_ast_node*) body = nullptr;
@@ -1442,13 +1562,13 @@ static laye_ast_node* laye_parse_grouped_statement(laye_parser* p)
     while (!laye_parser_is_eof(p) && !laye_parser_check(p, '}'))
     {
         laye_ast_node* declarationOrStatement = laye_parse_declaration_or_statement(p);
-        arrput(body, declarationOrStatement);
+        laye_parser_list_put(p, body, declarationOrStatement);
     }
 
-    laye_token* lastToken = nullptr;
+    laye_token lastToken = { 0 };
     laye_parser_expect_out(p, '}', nullptr, &lastToken);
 
-    layec_location groupLocation = layec_location_combine(firstToken->location, lastToken->location);
+    layec_location groupLocation = layec_location_combine(firstToken.location, lastToken.location);
 
     laye_ast_node* groupedStatement = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_BLOCK, groupLocation);
     groupedStatement->statements = body;
@@ -1460,11 +1580,10 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
 {
     assert(p != nullptr);
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
-    layec_location startLocation = current->location;
-    switch (current->kind)
+    layec_location startLocation = current.location;
+    switch (current.kind)
     {
         case '{':
         {
@@ -1473,7 +1592,7 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
 
         case LAYE_TOKEN_RETURN:
         {
-            layec_location returnLocation = current->location;
+            layec_location returnLocation = current.location;
             laye_parser_advance(p);
 
             laye_ast_node* returnValue = nullptr;
@@ -1493,7 +1612,7 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
         // TODO(local): break/continue targets
         case LAYE_TOKEN_BREAK:
         {
-            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_BREAK, current->location);
+            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_BREAK, current.location);
             laye_parser_advance(p);
             laye_parser_expect(p, ';', nullptr);
             return resultNode;
@@ -1501,7 +1620,7 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
 
         case LAYE_TOKEN_CONTINUE:
         {
-            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_CONTINUE, current->location);
+            laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_CONTINUE, current.location);
             laye_parser_advance(p);
             laye_parser_expect(p, ';', nullptr);
             return resultNode;
@@ -1513,7 +1632,7 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
 
             if (laye_parser_check(p, LAYE_TOKEN_RETURN))
             {
-                layec_location returnLocation = layec_location_combine(startLocation, current->location);
+                layec_location returnLocation = layec_location_combine(startLocation, current.location);
                 laye_parser_advance(p);
 
                 laye_ast_node* returnValue = nullptr;
@@ -1531,14 +1650,14 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
             }
             else if (laye_parser_check(p, LAYE_TOKEN_BREAK))
             {
-                layec_location returnLocation = layec_location_combine(startLocation, current->location);
+                layec_location returnLocation = layec_location_combine(startLocation, current.location);
                 laye_parser_advance(p);
                 laye_parser_expect(p, ';', nullptr);
-                laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_YIELD_BREAK, current->location);
+                laye_ast_node* resultNode = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_YIELD_BREAK, current.location);
                 return resultNode;
             }
 
-            layec_location yieldLocation = current->location;
+            layec_location yieldLocation = current.location;
 
             laye_ast_node* yieldValue = nullptr;
             if (!laye_parser_check(p, ';'))
@@ -1583,7 +1702,7 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
                     .condition = conditionNode,
                     .body = conditionalBodyNode,
                 };
-                arrput(conditionals, conditional);
+                laye_parser_list_put(p, conditionals, conditional);
                 lastLocation = conditionalBodyNode->location;
 
                 if (laye_parser_check(p, LAYE_TOKEN_ELSE) && laye_parser_peek_check(p, LAYE_TOKEN_IF))
@@ -1656,7 +1775,7 @@ static laye_ast_node* laye_parse_statement(laye_parser* p)
             laye_ast_node* condition = laye_parse_expression(p);
             laye_parser_expect_out(p, ';', nullptr, &current);
 
-            layec_location location = layec_location_combine(startLocation, current->location);
+            layec_location location = layec_location_combine(startLocation, current.location);
             laye_ast_node* ifNode = laye_ast_node_alloc(p, LAYE_AST_NODE_STATEMENT_DO_WHILE, location);
             ifNode->_while.condition = condition;
             ifNode->_while.body = body;
@@ -1694,9 +1813,8 @@ static list(laye_ast_template_parameter) laye_parse_template_parameters(laye_par
 {
     assert(p != nullptr);
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
-    assert(current->kind == '<', "when calling laye_parse_template_parameters, the current token must be '<'");
+    laye_token current = laye_parser_current(p);
+    assert(current.kind == '<', "when calling laye_parse_template_parameters, the current token must be '<'");
 
     list(laye_ast_template_parameter) result = nullptr;
 
@@ -1706,16 +1824,15 @@ static list(laye_ast_template_parameter) laye_parse_template_parameters(laye_par
     {
         if (laye_parser_check(p, LAYE_TOKEN_IDENTIFIER) && (laye_parser_peek_check(p, ',') || laye_parser_peek_check(p, '>')))
         {
-            laye_token* typeParamToken = laye_parser_current(p);
-            assert(typeParamToken != nullptr);
-            string typeParamName = layec_intern_location_text(p->context, typeParamToken->location);
+            laye_token typeParamToken = laye_parser_current(p);
+            layec_symbol typeParamName = typeParamToken.symbol;
             laye_parser_advance(p);
 
             laye_ast_template_parameter param = {
                 .kind = LAYE_TEMPLATE_PARAM_TYPE,
                 .name = typeParamName,
             };
-            arrput(result, param);
+            laye_parser_list_put(p, result, param);
         }
         else
         {
@@ -1724,16 +1841,15 @@ static list(laye_ast_template_parameter) laye_parse_template_parameters(laye_par
             assert(typeSuccess);
             assert(valueType != nullptr);
 
-            laye_token* valueNameToken = laye_parser_expect_identifier(p, nullptr);
-            assert(valueNameToken != nullptr);
-            string valueName = layec_intern_location_text(p->context, valueNameToken->location);
+            laye_token valueNameToken = laye_parser_expect_identifier(p, nullptr);
+            layec_symbol valueName = valueNameToken.symbol;
 
             laye_ast_template_parameter param = {
                 .kind = LAYE_TEMPLATE_PARAM_VALUE,
                 .valueType = valueType,
                 .name = valueName,
             };
-            arrput(result, param);
+            laye_parser_list_put(p, result, param);
         }
 
         if (!laye_parser_check(p, ','))
@@ -1743,16 +1859,16 @@ static list(laye_ast_template_parameter) laye_parse_template_parameters(laye_par
         if (!laye_parser_check(p, '>'))
             continue;
 
-        layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p)->location, "Type parameter expected");
+        layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p).location, "Type parameter expected");
         break;
     }
 
-    laye_token* closingToken = nullptr;
+    laye_token closingToken = { 0 };
     laye_parser_expect_out(p, '>', nullptr, &closingToken);
 
     if (arrlenu(result) == 0)
     {
-        layec_issue_diagnostic(p->context, SEV_ERROR, closingToken->location, "Template parameter lists cannot be empty");
+        layec_issue_diagnostic(p->context, SEV_ERROR, closingToken.location, "Template parameter lists cannot be empty");
     }
 
     return result;
@@ -1765,20 +1881,19 @@ static laye_token_kind laye_parser_expect_overloadable_operator(laye_parser* p,
     laye_token_kind operator = LAYE_TOKEN_INVALID;
     layec_location totalLocation = { 0 };
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
     #define SIMPLE_OPERATOR(TK) case TK: \
         operator = TK; \
-        totalLocation = current->location; \
+        totalLocation = current.location; \
         laye_parser_advance(p); \
         break;
 
-    switch (current->kind)
+    switch (current.kind)
     {
         default:
         {
-            layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Expected overloadable operator.");
+            layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Expected overloadable operator.");
         } break;
 
         SIMPLE_OPERATOR('+')
@@ -1803,19 +1918,19 @@ static laye_token_kind laye_parser_expect_overloadable_operator(laye_parser* p,
         case '(':
         {
             operator = LAYE_TOKEN_OPERATOR_INVOKE;
-            totalLocation = current->location;
+            totalLocation = current.location;
             laye_parser_advance(p);
             laye_parser_expect_out(p, ')', nullptr, &current);
-            totalLocation = layec_location_combine(totalLocation, current->location);
+            totalLocation = layec_location_combine(totalLocation, current.location);
         } break;
 
         case '[':
         {
             operator = LAYE_TOKEN_OPERATOR_INVOKE;
-            totalLocation = current->location;
+            totalLocation = current.location;
             laye_parser_advance(p);
             laye_parser_expect_out(p, ']', nullptr, &current);
-            totalLocation = layec_location_combine(totalLocation, current->location);
+            totalLocation = layec_location_combine(totalLocation, current.location);
         } break;
     }
 
@@ -1824,11 +1939,11 @@ static laye_token_kind laye_parser_expect_overloadable_operator(laye_parser* p,
     return operator;
 }
 
-static laye_ast_node* laye_parse_declaration_continue(laye_parser* p, list(laye_ast_modifier) modifiers, laye_ast_node* declType, string name, layec_location nameLocation, laye_token_kind operator)
+static laye_ast_node* laye_parse_declaration_continue(laye_parser* p, list(laye_ast_modifier) modifiers, laye_ast_node* declType, layec_symbol name, layec_location nameLocation, laye_token_kind operator)
 {
     assert(p != nullptr);
     assert(declType != nullptr);
-    assert(name.count > 0);
+    assert(name != 0);
 
     layec_location startLocation = arrlenu(modifiers) != 0 ? modifiers[0].location : declType->location;
 
@@ -1866,7 +1981,7 @@ static laye_ast_node* laye_parse_declaration_continue(laye_parser* p, list(laye_
             }
 
             laye_ast_node* paramTypeSyntax = nullptr;
-            laye_token* paramNameToken = nullptr;
+            laye_token paramNameToken = { 0 };
 
             laye_ast_node* paramBinding = nullptr;
 
@@ -1875,9 +1990,9 @@ static laye_ast_node* laye_parse_declaration_continue(laye_parser* p, list(laye_
                 paramNameToken = laye_parser_current(p);
                 laye_parser_advance(p);
 
-                paramTypeSyntax = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_INVALID, paramNameToken->location);
+                paramTypeSyntax = laye_ast_node_alloc(p, LAYE_AST_NODE_TYPE_INVALID, paramNameToken.location);
 
-                layec_issue_diagnostic(p->context, SEV_ERROR, paramNameToken->location, "Parameter type missing.");
+                layec_issue_diagnostic(p->context, SEV_ERROR, paramNameToken.location, "Parameter type missing.");
             }
             else
             {
@@ -1890,13 +2005,12 @@ static laye_ast_node* laye_parse_declaration_continue(laye_parser* p, list(laye_
             }
             
             assert(paramTypeSyntax != nullptr);
-            assert(paramNameToken != nullptr);
             
-            paramBinding = laye_ast_node_alloc(p, LAYE_AST_NODE_BINDING_DECLARATION, layec_location_combine(paramTypeSyntax->location, paramNameToken->location));
+            paramBinding = laye_ast_node_alloc(p, LAYE_AST_NODE_BINDING_DECLARATION, layec_location_combine(paramTypeSyntax->location, paramNameToken.location));
             paramBinding->bindingDeclaration.declaredType = paramTypeSyntax;
-            paramBinding->bindingDeclaration.name = layec_intern_location_text(p->context, paramNameToken->location);
+            paramBinding->bindingDeclaration.name = paramNameToken.symbol;
 
-            arrput(parameterBindingNodes, paramBinding);
+            laye_parser_list_put(p, parameterBindingNodes, paramBinding);
             
             if (!laye_parser_check(p, ','))
                 break;
@@ -1905,14 +2019,14 @@ static laye_ast_node* laye_parse_declaration_continue(laye_parser* p, list(laye_
             if (!laye_parser_check(p, ')'))
                 continue;
 
-            layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p)->location, "Expected parameter.");
+            layec_issue_diagnostic(p->context, SEV_ERROR, laye_parser_current(p).location, "Expected parameter.");
             break;
         }
 
         laye_parser_expect(p, ')', nullptr);
 
         laye_ast_node* functionBody = nullptr;
-        laye_token* lastToken = nullptr;
+        laye_token lastToken = { 0 };
         if (laye_parser_check(p, '{'))
             functionBody = laye_parse_grouped_statement(p);
         else if (laye_parser_check(p, LAYE_TOKEN_EQUAL_GREATER))
@@ -1923,7 +2037,7 @@ static laye_ast_node* laye_parse_declaration_continue(laye_parser* p, list(laye_
         }
         else laye_parser_expect_out(p, ';', nullptr, &lastToken);
 
-        layec_location lastLocation = lastToken != nullptr ? lastToken->location : functionBody->location;
+        layec_location lastLocation = lastToken.kind != LAYE_TOKEN_INVALID ? lastToken.location : functionBody->location;
         layec_location location = layec_location_combine(startLocation, lastLocation);
         laye_ast_node* functionDeclaration = laye_ast_node_alloc(p, LAYE_AST_NODE_FUNCTION_DECLARATION, location);
         functionDeclaration->functionDeclaration.modifiers = modifiers;
@@ -1977,12 +2091,12 @@ static laye_ast_node* laye_parse_field_declaration(laye_parser* p)
     bool typeSuccess = laye_parser_try_parse_type(p, &fieldType, true);
     assert(typeSuccess);
 
-    laye_token* fieldNameToken = laye_parser_expect_identifier(p, nullptr);
-    string fieldName = layec_intern_location_text(p->context, fieldNameToken->location);
+    laye_token fieldNameToken = laye_parser_expect_identifier(p, nullptr);
+    layec_symbol fieldName = fieldNameToken.symbol;
 
     laye_parser_expect(p, ';', nullptr);
 
-    laye_ast_node* fieldBinding = laye_ast_node_alloc(p, LAYE_AST_NODE_BINDING_DECLARATION, fieldNameToken->location);
+    laye_ast_node* fieldBinding = laye_ast_node_alloc(p, LAYE_AST_NODE_BINDING_DECLARATION, fieldNameToken.location);
     fieldBinding->bindingDeclaration.declaredType = fieldType;
     fieldBinding->bindingDeclaration.name = fieldName;
 
@@ -1995,8 +2109,7 @@ static laye_ast_node* laye_parse_declaration_or_statement(laye_parser* p)
     // TODO(local): report EOF error and return EOF node?
     assert(!laye_parser_is_eof(p));
 
-    laye_token* current = laye_parser_current(p);
-    assert(current != nullptr);
+    laye_token current = laye_parser_current(p);
 
     list(laye_ast_modifier) modifiers = nullptr;
     bool appliedModifiers[LAYE_AST_MODIFIER_COUNT] = { 0 };
@@ -2005,17 +2118,17 @@ static laye_ast_node* laye_parse_declaration_or_statement(laye_parser* p)
     while (!laye_parser_is_eof(p))
     {
         current = laye_parser_current(p);
-        switch (current->kind)
+        switch (current.kind)
         {
 #define MODIFIER_CASE(K, M) \
             case K: \
             { \
                 if (appliedModifiers[M]) { \
-                    layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Duplicate modifier."); \
+                    layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Duplicate modifier."); \
                 } \
                 appliedModifiers[M] = true; \
-                laye_ast_modifier modifier = (laye_ast_modifier){ .kind = M, .location = current->location }; \
-                arrput(modifiers, modifier); \
+                laye_ast_modifier modifier = (laye_ast_modifier){ .kind = M, .location = current.location }; \
+                laye_parser_list_put(p, modifiers, modifier); \
                 laye_parser_advance(p); \
             } break
             MODIFIER_CASE(LAYE_TOKEN_EXPORT, LAYE_AST_MODIFIER_EXPORT);
@@ -2025,7 +2138,7 @@ static laye_ast_node* laye_parse_declaration_or_statement(laye_parser* p)
             case LAYE_TOKEN_FOREIGN:
             {
                 if (appliedModifiers[LAYE_AST_MODIFIER_FOREIGN]) {
-                    layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Duplicate modifier.");
+                    layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Duplicate modifier.");
                 }
                 appliedModifiers[LAYE_AST_MODIFIER_FOREIGN] = true;
                 laye_parser_advance(p);
@@ -2034,22 +2147,22 @@ static laye_ast_node* laye_parse_declaration_or_statement(laye_parser* p)
                 if (laye_parser_check(p, LAYE_TOKEN_LITERAL_STRING))
                 {
                     current = laye_parser_current(p);
-                    foreignName = current->stringValue;
+                    foreignName = current.stringValue;
                     laye_parser_advance(p);
                 }
 
                 laye_ast_modifier foreignModifier = (laye_ast_modifier){
                     .kind = LAYE_AST_MODIFIER_FOREIGN,
-                    .location = current->location,
+                    .location = current.location,
                     .foreignName = foreignName,
                 };
-                arrput(modifiers, foreignModifier);
+                laye_parser_list_put(p, modifiers, foreignModifier);
             } break;
 
             case LAYE_TOKEN_CALLCONV:
             {
                 if (appliedModifiers[LAYE_AST_MODIFIER_CALLCONV]) {
-                    layec_issue_diagnostic(p->context, SEV_ERROR, current->location, "Duplicate modifier.");
+                    layec_issue_diagnostic(p->context, SEV_ERROR, current.location, "Duplicate modifier.");
                 }
                 appliedModifiers[LAYE_AST_MODIFIER_CALLCONV] = true;
                 laye_parser_advance(p);
@@ -2060,10 +2173,10 @@ static laye_ast_node* laye_parse_declaration_or_statement(laye_parser* p)
 
                 laye_ast_modifier callconvModifier = (laye_ast_modifier){
                     .kind = LAYE_AST_MODIFIER_CALLCONV,
-                    .location = current->location,
+                    .location = current.location,
                     .callingConventionKind = callingConventionNode,
                 };
-                arrput(modifiers, callconvModifier);
+                laye_parser_list_put(p, modifiers, callconvModifier);
             } break;
 
             default: goto after_modifier_parse;
@@ -2073,15 +2186,15 @@ static laye_ast_node* laye_parse_declaration_or_statement(laye_parser* p)
     }
 
 after_modifier_parse:;
-    switch (current->kind)
+    switch (current.kind)
     {
         case LAYE_TOKEN_STRUCT:
         {
-            layec_location startLocation = current->location;
+            layec_location startLocation = current.location;
             laye_parser_advance(p);
 
-            laye_token* nameToken = laye_parser_expect_identifier(p, nullptr);
-            string name = layec_intern_location_text(p->context, nameToken->location);
+            laye_token nameToken = laye_parser_expect_identifier(p, nullptr);
+            layec_symbol name = nameToken.symbol;
 
             list(laye_ast_template_parameter) templateParameters = nullptr;
             if (laye_parser_check(p, '<'))
@@ -2107,12 +2220,12 @@ after_modifier_parse:;
                         laye_ast_struct_variant variant = {
                             .isVoid = true,
                         };
-                        arrput(variants, variant);
+                        laye_parser_list_put(p, variants, variant);
                     }
                     else
                     {
-                        laye_token* variantNameToken = laye_parser_expect_identifier(p, nullptr);
-                        string variantName = layec_intern_location_text(p->context, variantNameToken->location);
+                        laye_token variantNameToken = laye_parser_expect_identifier(p, nullptr);
+                        layec_symbol variantName = variantNameToken.symbol;
                         
                         list(laye_ast_node*) variantFieldBindings = nullptr;
                         if (laye_parser_check(p, ';'))
@@ -2126,7 +2239,7 @@ after_modifier_parse:;
                             while (!laye_parser_is_eof(p) && !laye_parser_check(p, '}'))
                             {
                                 laye_ast_node* fieldBinding = laye_parse_field_declaration(p);
-                                arrput(variantFieldBindings, fieldBinding);
+                                laye_parser_list_put(p, variantFieldBindings, fieldBinding);
                             }
 
                             laye_parser_expect(p, '}', nullptr);
@@ -2136,13 +2249,13 @@ after_modifier_parse:;
                             .name = variantName,
                             .fieldBindings = variantFieldBindings
                         };
-                        arrput(variants, variant);
+                        laye_parser_list_put(p, variants, variant);
                     }
                 }
                 else
                 {
                     laye_ast_node* fieldBinding = laye_parse_field_declaration(p);
-                    arrput(fieldBindings, fieldBinding);
+                    laye_parser_list_put(p, fieldBindings, fieldBinding);
                 }
             }
             
@@ -2161,11 +2274,11 @@ after_modifier_parse:;
 
         case LAYE_TOKEN_ENUM:
         {
-            layec_location startLocation = current->location;
+            layec_location startLocation = current.location;
             laye_parser_advance(p);
 
-            laye_token* nameToken = laye_parser_expect_identifier(p, nullptr);
-            string name = layec_intern_location_text(p->context, nameToken->location);
+            laye_token nameToken = laye_parser_expect_identifier(p, nullptr);
+            layec_symbol name = nameToken.symbol;
 
             list(laye_ast_template_parameter) templateParameters = nullptr;
             if (laye_parser_check(p, '<'))
@@ -2178,8 +2291,8 @@ after_modifier_parse:;
             list(laye_ast_enum_variant) variants = nullptr;
             while (!laye_parser_is_eof(p) && !laye_parser_check(p, '}'))
             {
-                laye_token* variantNameToken = laye_parser_expect_identifier(p, nullptr);
-                string variantName = layec_intern_location_text(p->context, variantNameToken->location);
+                laye_token variantNameToken = laye_parser_expect_identifier(p, nullptr);
+                layec_symbol variantName = variantNameToken.symbol;
 
                 laye_ast_node* variantValue = nullptr;
                 if (laye_parser_check(p, '='))
@@ -2192,7 +2305,7 @@ after_modifier_parse:;
                     .name = variantName,
                     .value = variantValue,
                 };
-                arrput(variants, variant);
+                laye_parser_list_put(p, variants, variant);
 
                 if (!laye_parser_check(p, ','))
                     break;
@@ -2215,6 +2328,7 @@ after_modifier_parse:;
         default:
         {
             usize startIndex = p->currentTokenIndex;
+            arena_marker startMarker = arena_mark(p->astArena);
 
             laye_ast_node* typeSyntax = nullptr;
             if (laye_parser_try_parse_type(p, &typeSyntax, false))
@@ -2222,14 +2336,12 @@ after_modifier_parse:;
                 assert(typeSyntax != nullptr);
 
                 current = laye_parser_current(p);
-                assert(current != nullptr);
 
                 layec_location declNameLocation = { 0 };
                 laye_token_kind operator = LAYE_TOKEN_INVALID;
-                // TODO(local): how will we free syntax nodes?
                 if (laye_parser_check(p, LAYE_TOKEN_OPERATOR))
                 {
-                    declNameLocation = laye_parser_current(p)->location;
+                    declNameLocation = laye_parser_current(p).location;
                     laye_parser_advance(p);
                     layec_location operatorLocation = { 0 };
                     operator = laye_parser_expect_overloadable_operator(p, &operatorLocation);
@@ -2237,17 +2349,18 @@ after_modifier_parse:;
                 }
                 else if (laye_parser_check(p, LAYE_TOKEN_IDENTIFIER))
                 {
-                    declNameLocation = current->location;
+                    declNameLocation = current.location;
                     laye_parser_advance(p);
                 }
                 else goto parse_decl_failed;
 
-                string declName = layec_intern_location_text(p->context, declNameLocation);
+                layec_symbol declName = laye_parser_intern_location_symbol(p, declNameLocation);
                 return laye_parse_declaration_continue(p, modifiers, typeSyntax, declName, declNameLocation, operator);
             }
 
         parse_decl_failed:;
             p->currentTokenIndex = startIndex;
+            arena_rewind(p->astArena, startMarker);
 
             if (arrlenu(modifiers) > 0)
             {
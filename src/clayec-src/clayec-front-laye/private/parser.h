@@ -19,7 +19,38 @@ typedef struct laye_parse_result
     arena_allocator* astArena;
 } laye_parse_result;
 
-list(laye_token*) laye_lex(layec_context* context, layec_fileid fileId, arena_allocator* tokenArena);
-laye_parse_result laye_parse(layec_context* context, layec_fileid fileId);
+typedef struct laye_lexer
+{
+    layec_context* context;
+    layec_fileid fileId;
+    // where the file's span of the location offset space starts, source position `n` is located at `baseOffset + n`.
+    u32 baseOffset;
+    // string literal values are allocated here.
+    arena_allocator* constantArena;
+    string sourceText;
+    rune currentRune;
+    usize currentPosition;
+} laye_lexer;
+
+// builds the tables shared by every lexer. lexers build them on first use, but this must be
+// called up front when lexers will be running on more than one thread.
+void laye_lexer_init_tables(void);
+// prepares `l` to lex the given file one token at a time.
+void laye_lexer_init(laye_lexer* l, layec_context* context, layec_fileid fileId, arena_allocator* constantArena);
+// lexes the next token into `outToken`, returns false once there are no tokens left.
+bool laye_lexer_next(laye_lexer* l, laye_token* outToken);
+
+// lexes the entire file at once.
+laye_token_buffer laye_lex(layec_context* context, layec_fileid fileId);
+// string literals are allocated in `constantArena`, which must only be used by the calling thread.
+laye_parse_result laye_parse(layec_context* context, layec_fileid fileId, arena_allocator* constantArena);
+
+// the key a file's tree is cached under, the hash of its source.
+u64 laye_ast_cache_hash_source(layec_context* context, layec_fileid fileId);
+// loads the file's tree from the context's ast cache directory instead of parsing it, returns false if it isn't cached.
+// string literals are allocated in `constantArena` as `laye_parse` would.
+bool laye_ast_cache_load(layec_context* context, layec_fileid fileId, u64 sourceHash, arena_allocator* constantArena, laye_parse_result* result);
+// writes the tree to the context's ast cache directory, silently doing nothing if it can't be.
+void laye_ast_cache_store(layec_context* context, u64 sourceHash, laye_ast* ast);
 
 #endif // PARSER_H
@@ -143,7 +143,55 @@ typedef struct laye_token
         int sizeParameter;
         u64 integerValue;
         string stringValue;
+        // the interned name of an identifier.
+        layec_symbol symbol;
     };
 } laye_token;
 
+typedef struct laye_token_payload
+{
+    u32 tokenIndex;
+    union
+    {
+        int sizeParameter;
+        u64 integerValue;
+        string stringValue;
+    };
+} laye_token_payload;
+
+// identifiers are the most common token with a payload, so their symbols get a side table of their own
+// rather than a whole `laye_token_payload` each.
+typedef struct laye_token_symbol
+{
+    u32 tokenIndex;
+    layec_symbol symbol;
+} laye_token_symbol;
+
+// packed token stream for a single source file, stored as parallel arrays indexed by token.
+// only identifiers, sized type names and literals carry a payload, those live in side tables sorted by token index.
+// the buffer may hold a window of the file's tokens, in which case token `i` is stored at `i - baseIndex`.
+typedef struct laye_token_buffer
+{
+    layec_fileid fileId;
+    usize baseIndex;
+    list(u16) kinds;
+    list(u32) offsets;
+    list(u32) lengths;
+    list(laye_token_payload) payloads;
+    list(laye_token_symbol) symbols;
+    // the bytes taken up by every token ever pushed, including those since discarded.
+    usize requestedBytes;
+} laye_token_buffer;
+
+// returns one past the index of the last token in the buffer.
+usize laye_token_buffer_count(laye_token_buffer* tokens);
+void laye_token_buffer_push(laye_token_buffer* tokens, laye_token token);
+laye_token laye_token_buffer_get(laye_token_buffer* tokens, usize index);
+laye_token_kind laye_token_buffer_get_kind(laye_token_buffer* tokens, usize index);
+// drops every token before `index` from the buffer, those tokens can no longer be accessed.
+void laye_token_buffer_discard_before(laye_token_buffer* tokens, usize index);
+void laye_token_buffer_destroy(laye_token_buffer* tokens);
+// describes the memory held by the buffer the way an arena's is described, so the two can be reported together.
+kos_arena_stats laye_token_buffer_get_stats(laye_token_buffer* tokens);
+
 #endif // TOKEN_H
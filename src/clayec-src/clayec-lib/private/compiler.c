@@ -1,10 +1,11 @@
-#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "kos/ansi.h"
 #include "kos/kos.h"
 #include "kos/platform.h"
+#include "kos/scan.h"
 
 #include "layec/compiler.h"
 #include "layec/diagnostic.h"
@@ -16,28 +17,528 @@ void layec_context_init(layec_context* context)
 
     context->constantArena = arena_create(default_allocator, 10 * 1024);
     assert(context->constantArena != nullptr);
+
+    context->filesMutex = mutex_create();
+    context->internMutex = mutex_create();
+    context->diagnosticMutex = mutex_create();
+    string_builder_init(&context->diagnosticBuilder, default_allocator);
+    string_builder_init(&context->diagnosticMessageBuilder, default_allocator);
+    // offset 0 is left out of every file, so a zeroed location can't be mistaken for one.
+    context->nextBaseOffset = 1;
+    context->traceStartNanoseconds = platform_monotonic_nanoseconds();
+
+    // the path index keeps its own copy of every key.
+    sh_new_strdup(context->filePathIndex);
+
+    layec_symbol emptySymbol = layec_intern_symbol(context, STRING_VIEW_LITERAL(""));
+    assert(emptySymbol == 0, "the empty name must be the first symbol");
+}
+
+static void finish_diagnostics(layec_context* context);
+
+void layec_context_deinit(layec_context* context)
+{
+    assert(context != nullptr);
+
+    for (usize i = 0; i < arrlenu(context->files); i++)
+    {
+        layec_source_file_info file = context->files[i];
+        arrfree(file.lineStarts);
+
+        if (!file.ownsSource)
+            continue;
+
+        platform_free_file(file.source);
+        // the full path of a file read from disk is built by `layec_context_add_file`.
+        deallocate(default_allocator, cast(void*) file.fullPath.memory);
+    }
+
+    arrfree(context->files);
+    shfree(context->filePathIndex);
+    hmfree(context->fileIdentityIndex);
+
+    arrfree(context->internedStrings);
+    arrfree(context->internedHashes);
+    if (context->internSlots != nullptr)
+        deallocate(default_allocator, context->internSlots);
+
+    arena_destroy(context->stringArena);
+    arena_destroy(context->constantArena);
+    for (usize i = 0; i < arrlenu(context->threadConstantArenas); i++)
+        arena_destroy(context->threadConstantArenas[i]);
+    arrfree(context->threadConstantArenas);
+    arrfree(context->memoryUsage);
+    arrfree(context->timeUsage);
+    arrfree(context->traceEvents);
+
+    finish_diagnostics(context);
+    string_builder_deallocate(&context->diagnosticBuilder);
+    string_builder_deallocate(&context->diagnosticMessageBuilder);
+
+    mutex_destroy(context->filesMutex);
+    mutex_destroy(context->internMutex);
+    mutex_destroy(context->diagnosticMutex);
+
+    *context = (layec_context){ 0 };
+}
+
+arena_allocator* layec_context_create_constant_arena(layec_context* context)
+{
+    assert(context != nullptr);
+
+    arena_allocator* constantArena = arena_create(default_allocator, 10 * 1024);
+    assert(constantArena != nullptr);
+
+    mutex_lock(context->filesMutex);
+    arrput(context->threadConstantArenas, constantArena);
+    mutex_unlock(context->filesMutex);
+
+    return constantArena;
+}
+
+static void add_memory_usage(list(layec_memory_usage)* memoryUsage, const char* tag, usize arenaCount, kos_arena_stats stats)
+{
+    for (usize i = 0; i < arrlenu(*memoryUsage); i++)
+    {
+        layec_memory_usage* usage = &(*memoryUsage)[i];
+        if (0 != strcmp(usage->tag, tag))
+            continue;
+
+        usage->arenaCount += arenaCount;
+        arena_stats_add(&usage->stats, stats);
+        return;
+    }
+
+    layec_memory_usage usage = { .tag = tag, .arenaCount = arenaCount, .stats = stats };
+    arrput(*memoryUsage, usage);
+}
+
+void layec_context_record_arena(layec_context* context, const char* tag, arena_allocator* arena)
+{
+    assert(context != nullptr);
+    assert(arena != nullptr);
+
+    if (!context->memoryReport)
+        return;
+
+    layec_context_record_memory_usage(context, tag, arena_get_stats(arena));
+}
+
+void layec_context_record_memory_usage(layec_context* context, const char* tag, kos_arena_stats stats)
+{
+    assert(context != nullptr);
+    assert(tag != nullptr);
+
+    if (!context->memoryReport)
+        return;
+
+    mutex_lock(context->filesMutex);
+    add_memory_usage(&context->memoryUsage, tag, 1, stats);
+    mutex_unlock(context->filesMutex);
+}
+
+static void print_memory_usage_row(FILE* stream, const char* tag, usize arenaCount, kos_arena_stats stats)
+{
+    fprintf(stream, "  %-10s %7zu %9zu %12zu %12zu %12zu %12zu %12zu %7zu %6zu\n", tag, arenaCount,
+        stats.pushCount, stats.requestedBytes, stats.usedBytes, stats.committedBytes, stats.peakCommittedBytes,
+        stats.wastedBytes, stats.blockCount, stats.largeBlockCount);
+}
+
+void layec_context_print_memory_report(layec_context* context, FILE* stream)
+{
+    assert(context != nullptr);
+    assert(stream != nullptr);
+
+    // the arenas the context still owns are reported alongside the recorded ones, without being recorded themselves.
+    list(layec_memory_usage) memoryUsage = nullptr;
+
+    mutex_lock(context->internMutex);
+    add_memory_usage(&memoryUsage, "string", 1, arena_get_stats(context->stringArena));
+    mutex_unlock(context->internMutex);
+
+    mutex_lock(context->filesMutex);
+    add_memory_usage(&memoryUsage, "constant", 1, arena_get_stats(context->constantArena));
+    for (usize i = 0; i < arrlenu(context->threadConstantArenas); i++)
+        add_memory_usage(&memoryUsage, "constant", 1, arena_get_stats(context->threadConstantArenas[i]));
+    for (usize i = 0; i < arrlenu(context->memoryUsage); i++)
+    {
+        layec_memory_usage usage = context->memoryUsage[i];
+        add_memory_usage(&memoryUsage, usage.tag, usage.arenaCount, usage.stats);
+    }
+    mutex_unlock(context->filesMutex);
+
+    fprintf(stream, "memory report (bytes, peaks are summed over the arenas of a tag):\n");
+    fprintf(stream, "  %-10s %7s %9s %12s %12s %12s %12s %12s %7s %6s\n", "arena", "count",
+        "pushes", "requested", "used", "committed", "peak", "wasted", "blocks", "large");
+
+    kos_arena_stats total = { 0 };
+    usize totalArenaCount = 0;
+    for (usize i = 0; i < arrlenu(memoryUsage); i++)
+    {
+        layec_memory_usage usage = memoryUsage[i];
+        print_memory_usage_row(stream, usage.tag, usage.arenaCount, usage.stats);
+        arena_stats_add(&total, usage.stats);
+        totalArenaCount += usage.arenaCount;
+    }
+
+    print_memory_usage_row(stream, "total", totalArenaCount, total);
+    arrfree(memoryUsage);
+}
+
+static THREAD_LOCAL layec_timer_scope* currentTimerScope = nullptr;
+// 0 until the thread ends its first traced scope.
+static THREAD_LOCAL u32 currentTraceThreadId = 0;
+
+static void add_time_usage(list(layec_time_usage)* timeUsage, const char* phase, layec_fileid fileId, usize count, u64 totalNanoseconds, u64 selfNanoseconds)
+{
+    for (usize i = 0; i < arrlenu(*timeUsage); i++)
+    {
+        layec_time_usage* usage = &(*timeUsage)[i];
+        if (usage->fileId != fileId || 0 != strcmp(usage->phase, phase))
+            continue;
+
+        usage->count += count;
+        usage->totalNanoseconds += totalNanoseconds;
+        usage->selfNanoseconds += selfNanoseconds;
+        return;
+    }
+
+    layec_time_usage usage = {
+        .phase = phase,
+        .fileId = fileId,
+        .count = count,
+        .totalNanoseconds = totalNanoseconds,
+        .selfNanoseconds = selfNanoseconds,
+    };
+    arrput(*timeUsage, usage);
+}
+
+void layec_timer_begin(layec_context* context, layec_timer_scope* scope, const char* phase, layec_fileid fileId)
+{
+    assert(context != nullptr);
+    assert(scope != nullptr);
+    assert(phase != nullptr);
+
+    if (!context->timeReport && !context->trace)
+    {
+        scope->phase = nullptr;
+        return;
+    }
+
+    *scope = (layec_timer_scope){
+        .phase = phase,
+        .fileId = fileId,
+        .parent = currentTimerScope,
+    };
+
+    currentTimerScope = scope;
+    scope->startNanoseconds = platform_monotonic_nanoseconds();
+}
+
+void layec_timer_end(layec_context* context, layec_timer_scope* scope)
+{
+    assert(context != nullptr);
+    assert(scope != nullptr);
+
+    if (scope->phase == nullptr)
+        return;
+
+    u64 elapsedNanoseconds = platform_monotonic_nanoseconds() - scope->startNanoseconds;
+
+    assert(currentTimerScope == scope, "timer scopes must end in the reverse order they began");
+    currentTimerScope = scope->parent;
+    if (scope->parent != nullptr)
+        scope->parent->childNanoseconds += elapsedNanoseconds;
+
+    u64 selfNanoseconds = elapsedNanoseconds > scope->childNanoseconds ? elapsedNanoseconds - scope->childNanoseconds : 0;
+
+    mutex_lock(context->filesMutex);
+    if (context->timeReport)
+        add_time_usage(&context->timeUsage, scope->phase, scope->fileId, 1, elapsedNanoseconds, selfNanoseconds);
+
+    if (context->trace)
+    {
+        if (currentTraceThreadId == 0)
+            currentTraceThreadId = ++context->traceThreadCount;
+
+        layec_trace_event event = {
+            .phase = scope->phase,
+            .fileId = scope->fileId,
+            .threadId = currentTraceThreadId,
+            .startNanoseconds = scope->startNanoseconds - context->traceStartNanoseconds,
+            .durationNanoseconds = elapsedNanoseconds,
+        };
+        arrput(context->traceEvents, event);
+    }
+    mutex_unlock(context->filesMutex);
+}
+
+void layec_timer_record(layec_context* context, const char* phase, layec_fileid fileId, u64 nanoseconds)
+{
+    assert(context != nullptr);
+    assert(phase != nullptr);
+
+    if (!context->timeReport)
+        return;
+
+    if (currentTimerScope != nullptr)
+        currentTimerScope->childNanoseconds += nanoseconds;
+
+    mutex_lock(context->filesMutex);
+    add_time_usage(&context->timeUsage, phase, fileId, 1, nanoseconds, nanoseconds);
+    mutex_unlock(context->filesMutex);
+}
+
+void layec_context_print_time_report(layec_context* context, FILE* stream)
+{
+    assert(context != nullptr);
+    assert(stream != nullptr);
+
+    mutex_lock(context->filesMutex);
+    list(layec_time_usage) timeUsage = nullptr;
+    arrsetlen(timeUsage, arrlenu(context->timeUsage));
+    if (arrlenu(timeUsage) > 0)
+        memcpy(timeUsage, context->timeUsage, arrlenu(timeUsage) * sizeof(layec_time_usage));
+    mutex_unlock(context->filesMutex);
+
+    // phases are listed in the order they were first timed.
+    list(layec_time_usage) phaseUsage = nullptr;
+    for (usize i = 0; i < arrlenu(timeUsage); i++)
+    {
+        layec_time_usage usage = timeUsage[i];
+        add_time_usage(&phaseUsage, usage.phase, 0, usage.count, usage.totalNanoseconds, usage.selfNanoseconds);
+    }
+
+    fprintf(stream, "time report (milliseconds, times on worker threads are summed):\n");
+    fprintf(stream, "  %-24s %9s %12s %12s\n", "phase", "count", "total", "self");
+    for (usize i = 0; i < arrlenu(phaseUsage); i++)
+    {
+        layec_time_usage usage = phaseUsage[i];
+        fprintf(stream, "  %-24s %9zu %12.3f %12.3f\n", usage.phase, usage.count,
+            cast(double) usage.totalNanoseconds / 1e6, cast(double) usage.selfNanoseconds / 1e6);
+    }
+
+    fprintf(stream, "\n  %-24s %-24s %9s %12s %12s\n", "file", "phase", "count", "total", "self");
+    for (usize i = 0; i < arrlenu(timeUsage); i++)
+    {
+        layec_fileid fileId = timeUsage[i].fileId;
+        if (fileId == 0)
+            continue;
+
+        // each file's phases are listed together, the first time the file comes up.
+        bool isFileListed = false;
+        for (usize j = 0; j < i && !isFileListed; j++)
+            isFileListed = timeUsage[j].fileId == fileId;
+        if (isFileListed)
+            continue;
+
+        string_view fileName = layec_context_get_file_name(context, fileId);
+        for (usize j = i; j < arrlenu(timeUsage); j++)
+        {
+            layec_time_usage usage = timeUsage[j];
+            if (usage.fileId != fileId)
+                continue;
+
+            fprintf(stream, "  %-24.*s %-24s %9zu %12.3f %12.3f\n", STRING_VIEW_EXPAND(fileName), usage.phase,
+                usage.count, cast(double) usage.totalNanoseconds / 1e6, cast(double) usage.selfNanoseconds / 1e6);
+        }
+    }
+
+    arrfree(phaseUsage);
+    arrfree(timeUsage);
+}
+
+void layec_append_json_string(string_builder* sb, string_view value)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    string_builder_append_cstring(sb, "\"");
+
+    // runs of characters which need no escaping are appended whole.
+    usize runStart = 0;
+    for (usize i = 0; i < value.count; i++)
+    {
+        uchar c = value.memory[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        string_builder_append_view(sb, string_view_slice(value, runStart, i - runStart));
+        runStart = i + 1;
+
+        switch (c)
+        {
+            case '"': string_builder_append_cstring(sb, "\\\""); break;
+            case '\\': string_builder_append_cstring(sb, "\\\\"); break;
+            case '\n': string_builder_append_cstring(sb, "\\n"); break;
+            case '\r': string_builder_append_cstring(sb, "\\r"); break;
+            case '\t': string_builder_append_cstring(sb, "\\t"); break;
+            default:
+            {
+                char escape[] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF], 0 };
+                string_builder_append_cstring(sb, escape);
+            } break;
+        }
+    }
+
+    string_builder_append_view(sb, string_view_slice(value, runStart, value.count - runStart));
+    string_builder_append_cstring(sb, "\"");
 }
 
-static layec_fileid try_read_file(layec_context* context, string_view name, string_view fullPath)
+bool layec_context_write_trace(layec_context* context, const char* path)
 {
-    usize numFiles = arrlenu(context->files);
-    for (usize i = 0; i < numFiles; i++)
+    assert(context != nullptr);
+    assert(path != nullptr);
+
+    FILE* stream = fopen(path, "wb");
+    if (stream == nullptr)
+        return false;
+
+    string_builder sb = { 0 };
+    string_builder_init(&sb, default_allocator);
+
+    // complete ("X") events are in microseconds, the fraction keeps the nanoseconds.
+    string_builder_append_cstring(&sb, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    mutex_lock(context->filesMutex);
+    u32 threadCount = context->traceThreadCount;
+    list(layec_trace_event) traceEvents = nullptr;
+    arrsetlen(traceEvents, arrlenu(context->traceEvents));
+    if (arrlenu(traceEvents) > 0)
+        memcpy(traceEvents, context->traceEvents, arrlenu(traceEvents) * sizeof(layec_trace_event));
+    mutex_unlock(context->filesMutex);
+
+    for (u32 threadId = 1; threadId <= threadCount; threadId++)
+    {
+        if (threadId > 1)
+            string_builder_append_rune(&sb, ',');
+        string_builder_append_format(&sb, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+            "\"args\":{\"name\":\"thread %u\"}}", threadId, threadId);
+    }
+
+    for (usize i = 0; i < arrlenu(traceEvents); i++)
+    {
+        layec_trace_event event = traceEvents[i];
+        string_builder_append_format(&sb, ",\n{\"name\":\"%s\",\"cat\":\"layec\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+            "\"ts\":%.3f,\"dur\":%.3f", event.phase, event.threadId,
+            cast(double) event.startNanoseconds / 1e3, cast(double) event.durationNanoseconds / 1e3);
+
+        if (event.fileId != 0)
+        {
+            string_builder_append_cstring(&sb, ",\"args\":{\"file\":");
+            layec_append_json_string(&sb, layec_context_get_file_name(context, event.fileId));
+            string_builder_append_rune(&sb, '}');
+        }
+
+        string_builder_append_rune(&sb, '}');
+    }
+
+    arrfree(traceEvents);
+
+    string_builder_append_cstring(&sb, "\n]}\n");
+
+    bool isWritten = sb.count == fwrite(sb.memory, 1, sb.count, stream);
+    isWritten = 0 == fclose(stream) && isWritten;
+
+    string_builder_deallocate(&sb);
+    return isWritten;
+}
+
+// gives the file the next span of the location offset space and adds it, `filesMutex` must be held.
+static layec_fileid add_file_locked(layec_context* context, layec_source_file_info file)
+{
+    // every span has one offset past its last byte, for locations at the end of the file.
+    assert(file.source.count < UINT32_MAX - context->nextBaseOffset, "source files are too large to be located");
+    file.baseOffset = context->nextBaseOffset;
+    context->nextBaseOffset += cast(u32) file.source.count + 1;
+
+    arrput(context->files, file);
+    return cast(layec_fileid) arrlenu(context->files);
+}
+
+// takes ownership of `fullPathString`, it's kept as the full path of a newly added file and released otherwise.
+static layec_fileid try_read_file(layec_context* context, string_view name, string fullPathString)
+{
+    string_view fullPath = string_slice(fullPathString, 0, fullPathString.count);
+    const char* fullPathCString = string_view_to_cstring(fullPath, nullptr);
+
+    mutex_lock(context->filesMutex);
+    layec_fileid existingId = shget(context->filePathIndex, fullPathCString);
+    mutex_unlock(context->filesMutex);
+
+    if (existingId != 0)
+    {
+        deallocate(default_allocator, cast(void*) fullPathCString);
+        string_deallocate(fullPathString);
+        return existingId;
+    }
+
+    // a path we haven't seen yet can still be a link to, or another spelling of, a file we have.
+    platform_file_identity identity = { 0 };
+    if (!platform_get_file_identity(fullPathCString, &identity))
+    {
+        deallocate(default_allocator, cast(void*) fullPathCString);
+        string_deallocate(fullPathString);
+        return 0;
+    }
+
+    mutex_lock(context->filesMutex);
+    existingId = hmget(context->fileIdentityIndex, identity);
+    if (existingId != 0)
+        shput(context->filePathIndex, fullPathCString, existingId);
+    mutex_unlock(context->filesMutex);
+
+    if (existingId != 0)
     {
-        layec_source_file_info info = context->files[i];
-        if (string_view_equals(info.fullPath, fullPath))
-            return i + 1;
+        deallocate(default_allocator, cast(void*) fullPathCString);
+        string_deallocate(fullPathString);
+        return existingId;
     }
 
+    // read without holding the lock so other threads aren't stalled on file IO.
+    // the file has no id until it's added, so the scope is given it just before it ends.
+    layec_timer_scope readScope;
+    layec_timer_begin(context, &readScope, "read", 0);
+
     platform_read_file_status readStatus = 0;
-    string fileSource = platform_read_file(string_view_to_cstring(fullPath, nullptr), nullptr, &readStatus);
+    string fileSource = platform_read_file(fullPathCString, nullptr, &readStatus);
 
     if (readStatus != KOS_PLATFORM_READ_FILE_SUCCESS)
+    {
+        layec_timer_end(context, &readScope);
+        deallocate(default_allocator, cast(void*) fullPathCString);
+        string_deallocate(fullPathString);
         return 0;
+    }
 
-    layec_fileid nextId = 1 + cast(layec_fileid) numFiles;
-    layec_source_file_info file = { name, fullPath, fileSource };
-    arrput(context->files, file);
+    mutex_lock(context->filesMutex);
 
+    // another thread may have added the same file while it was being read.
+    existingId = hmget(context->fileIdentityIndex, identity);
+    if (existingId != 0)
+    {
+        shput(context->filePathIndex, fullPathCString, existingId);
+        mutex_unlock(context->filesMutex);
+
+        readScope.fileId = existingId;
+        layec_timer_end(context, &readScope);
+
+        platform_free_file(fileSource);
+        deallocate(default_allocator, cast(void*) fullPathCString);
+        string_deallocate(fullPathString);
+        return existingId;
+    }
+
+    layec_source_file_info file = { .name = name, .fullPath = fullPath, .source = fileSource, .ownsSource = true };
+    layec_fileid nextId = add_file_locked(context, file);
+    shput(context->filePathIndex, fullPathCString, nextId);
+    hmput(context->fileIdentityIndex, identity, nextId);
+
+    mutex_unlock(context->filesMutex);
+
+    readScope.fileId = nextId;
+    layec_timer_end(context, &readScope);
+
+    deallocate(default_allocator, cast(void*) fullPathCString);
     return nextId;
 }
 
@@ -49,64 +550,153 @@ layec_fileid layec_context_add_file(layec_context* context, string_view name, st
         string relativeFullPath = platform_path_combine(relativeParent, name);
         assert(relativeFullPath.count > 0);
         
-        string_view relativeFullPathView = string_slice(relativeFullPath, 0, relativeFullPath.count);
-        layec_fileid relativeFileId = try_read_file(context, name, relativeFullPathView);
-
+        layec_fileid relativeFileId = try_read_file(context, name, relativeFullPath);
         if (relativeFileId != 0)
             return relativeFileId;
-
-        string_deallocate(relativeFullPath);
     }
     
+    // the full path can only be resolved for files which exist.
     string cwdFullPath = platform_full_path(name);
-    assert(cwdFullPath.count > 0);
+    if (cwdFullPath.count == 0)
+        return 0;
     
-    string_view cwdFullPathView = string_slice(cwdFullPath, 0, cwdFullPath.count);
-    layec_fileid cwdFileId = try_read_file(context, name, cwdFullPathView);
-
-    return cwdFileId;
+    return try_read_file(context, name, cwdFullPath);
 }
 
 layec_fileid layec_context_add_file_with_source(layec_context* context, string_view name, string source)
 {
-    usize numFiles = arrlenu(context->files);
-    for (usize i = 0; i < numFiles; i++)
+    const char* nameCString = string_view_to_cstring(name, nullptr);
+    layec_fileid nextId = 0;
+
+    mutex_lock(context->filesMutex);
+
+    if (shget(context->filePathIndex, nameCString) == 0)
     {
-        layec_source_file_info info = context->files[i];
-        if (string_view_equals(info.fullPath, name))
-        {
-            return 0;
-        }
+        layec_source_file_info file = { .name = name, .fullPath = name, .source = source };
+        nextId = add_file_locked(context, file);
+        shput(context->filePathIndex, nameCString, nextId);
     }
 
-    layec_fileid nextId = 1 + cast(layec_fileid) numFiles;
-    layec_source_file_info file = { name, name, source };
-    arrput(context->files, file);
+    mutex_unlock(context->filesMutex);
+
+    deallocate(default_allocator, cast(void*) nameCString);
     return nextId;
 }
 
-string_view layec_context_get_file_name(layec_context* context, layec_fileid fileId)
+static layec_source_file_info get_file_info(layec_context* context, layec_fileid fileId)
 {
+    assert(fileId != 0);
+
+    mutex_lock(context->filesMutex);
     assert(fileId <= arrlenu(context->files));
+    layec_source_file_info info = context->files[fileId - 1];
+    mutex_unlock(context->filesMutex);
+
+    return info;
+}
+
+string_view layec_context_get_file_name(layec_context* context, layec_fileid fileId)
+{
     if (fileId == 0)
         return STRING_VIEW_LITERAL("<invalid file>");
-    return context->files[fileId - 1].name;
+    return get_file_info(context, fileId).name;
 }
 
 string_view layec_context_get_file_full_path(layec_context* context, layec_fileid fileId)
 {
-    assert(fileId <= arrlenu(context->files));
     if (fileId == 0)
         return STRING_VIEW_LITERAL("<invalid file>");
-    return context->files[fileId - 1].fullPath;
+    return get_file_info(context, fileId).fullPath;
 }
 
 string layec_context_get_file_source(layec_context* context, layec_fileid fileId)
 {
-    assert(fileId <= arrlenu(context->files));
     if (fileId == 0)
         return STRING_EMPTY;
-    return context->files[fileId - 1].source;
+    return get_file_info(context, fileId).source;
+}
+
+u32 layec_context_get_file_base_offset(layec_context* context, layec_fileid fileId)
+{
+    return get_file_info(context, fileId).baseOffset;
+}
+
+layec_fileid layec_context_decode_location(layec_context* context, layec_location loc, usize* outFileOffset)
+{
+    assert(context != nullptr);
+
+    if (outFileOffset) *outFileOffset = 0;
+    if (loc.offset == 0)
+        return 0;
+
+    mutex_lock(context->filesMutex);
+
+    // spans are laid out in file order, find the last file which starts at or before the location.
+    usize low = 0, high = arrlenu(context->files);
+    while (high - low > 1)
+    {
+        usize middle = low + (high - low) / 2;
+        if (context->files[middle].baseOffset <= loc.offset)
+            low = middle;
+        else high = middle;
+    }
+
+    assert(low < arrlenu(context->files) && context->files[low].baseOffset <= loc.offset, "location %u is not in any file", loc.offset);
+    u32 baseOffset = context->files[low].baseOffset;
+    mutex_unlock(context->filesMutex);
+
+    if (outFileOffset) *outFileOffset = loc.offset - baseOffset;
+    return cast(layec_fileid) (low + 1);
+}
+
+static list(u32) build_line_starts(string source)
+{
+    list(u32) lineStarts = nullptr;
+    arrput(lineStarts, 0);
+
+    usize position = 0;
+    while ((position = scan_find_newline(source.memory, position, source.count)) < source.count)
+    {
+        position++;
+        arrput(lineStarts, cast(u32) position);
+    }
+
+    return lineStarts;
+}
+
+void layec_context_get_line_info(layec_context* context, layec_fileid fileId, usize offset,
+    u32* lineNumber, u32* lineStartOffset, u32* lineEndOffset)
+{
+    assert(context != nullptr);
+    assert(fileId != 0);
+
+    mutex_lock(context->filesMutex);
+    assert(fileId <= arrlenu(context->files));
+
+    layec_source_file_info* file = &context->files[fileId - 1];
+    if (file->lineStarts == nullptr)
+        file->lineStarts = build_line_starts(file->source);
+
+    // the table is never modified once built, so it can be read without the lock.
+    string source = file->source;
+    list(u32) lineStarts = file->lineStarts;
+    mutex_unlock(context->filesMutex);
+
+    assert(offset <= source.count);
+
+    // find the last line which starts at or before `offset`.
+    usize low = 0, high = arrlenu(lineStarts);
+    while (high - low > 1)
+    {
+        usize middle = low + (high - low) / 2;
+        if (lineStarts[middle] <= offset)
+            low = middle;
+        else high = middle;
+    }
+
+    if (lineNumber) *lineNumber = cast(u32) (low + 1);
+    if (lineStartOffset) *lineStartOffset = lineStarts[low];
+    if (lineEndOffset) *lineEndOffset = low + 1 < arrlenu(lineStarts) ? lineStarts[low + 1] - 1 : cast(u32) source.count;
 }
 
 static const char *severityNames[SEV_COUNT] = {
@@ -125,65 +715,61 @@ static const char *severityColors[SEV_COUNT] = {
     ANSI_COLOR_MAGENTA,
 };
 
-static void get_line_from_source(string source, layec_location loc,   
-    u32* lineNumber, u32* lineStartOffset, u32* lineEndOffset)
+string_view layec_view_from_location(layec_context* context, layec_location loc)
 {
-    assert(source.memory);
-    assert(lineNumber);
-    assert(lineStartOffset);
-    assert(lineEndOffset);
-
-    /// Seek to the start of the line. Keep track of the line number.
-    u32 line = 1, line_start = 0;
-    for (u32 i = cast(u32) loc.offset; i > 0; --i) {
-        if (source.memory[i] == '\n') {
-            if (!line_start)
-                line_start = i + 1;
-            line++;
-        }
-    }
+    usize offset = 0;
+    layec_fileid fileId = layec_context_decode_location(context, loc, &offset);
+    string source = layec_context_get_file_source(context, fileId);
+    return (string_view){ source.memory + offset, loc.length };
+}
 
-    /// Don’t include the newline in the line.
-    if (source.memory[line_start] == '\n') ++line_start;
+static void intern_table_grow(layec_context* context)
+{
+    usize newSlotCount = context->internSlotCount == 0 ? 1024 : context->internSlotCount * 2;
+    u32* newSlots = allocate(default_allocator, newSlotCount * sizeof(u32));
+    assert(newSlots != nullptr);
+    memset(newSlots, 0, newSlotCount * sizeof(u32));
 
-    /// Seek to the end of the line.
-    u32 line_end = loc.offset;
-    while (line_end < source.count && source.memory[line_end] != '\n')
-        line_end++;
+    usize mask = newSlotCount - 1;
+    usize internCount = arrlenu(context->internedStrings);
+    for (usize i = 0; i < internCount; i++)
+    {
+        usize slot = cast(usize) context->internedHashes[i] & mask;
+        while (newSlots[slot] != 0)
+            slot = (slot + 1) & mask;
+        newSlots[slot] = cast(u32) (i + 1);
+    }
 
-    /// Return the results.
-    if (lineNumber) *lineNumber = line;
-    if (lineStartOffset) *lineStartOffset = line_start;
-    if (lineEndOffset) *lineEndOffset = line_end;
-}
+    if (context->internSlots != nullptr)
+        deallocate(default_allocator, context->internSlots);
 
-string_view layec_view_from_location(layec_context* context, layec_location loc)
-{
-    string source = layec_context_get_file_source(context, loc.fileId);
-    return (string_view){ source.memory + loc.offset, loc.length };
+    context->internSlots = newSlots;
+    context->internSlotCount = newSlotCount;
 }
 
-string layec_intern_string_view(layec_context* context, string_view view)
+static layec_symbol intern_view_locked(layec_context* context, string_view view, u64 hash)
 {
-    assert(context != nullptr);
+    // keep the load factor at or below one half so probe sequences stay short.
+    if (2 * (arrlenu(context->internedStrings) + 1) > context->internSlotCount)
+        intern_table_grow(context);
 
-    if (view.count == 0)
-        return (string){ .memory = cast(const uchar*) "<empty>", .allocator = nullptr, .count = 7 };
+    usize mask = context->internSlotCount - 1;
+    usize slot = cast(usize) hash & mask;
 
-    usize internCount = arrlenu(context->internedStrings);
-    for (usize i = 0; i < internCount; i++)
+    while (context->internSlots[slot] != 0)
     {
-        string s = context->internedStrings[i];
-        if (s.count != view.count)
-            continue;
-
-        if (0 == strncmp(cast(const char*) view.memory, cast(const char*) s.memory, view.count))
+        layec_symbol symbol = context->internSlots[slot] - 1;
+        if (context->internedHashes[symbol] == hash)
         {
-            return s;
+            string s = context->internedStrings[symbol];
+            if (s.count == view.count && 0 == memcmp(view.memory, s.memory, view.count))
+                return symbol;
         }
+
+        slot = (slot + 1) & mask;
     }
 
-    uchar* newMemory = arena_push(context->stringArena, view.count + 1);
+    uchar* newMemory = arena_push_uninit(context->stringArena, view.count + 1, 1);
     memcpy(newMemory, view.memory, view.count);
     newMemory[view.count] = 0;
 
@@ -194,46 +780,71 @@ string layec_intern_string_view(layec_context* context, string_view view)
         .isNulTerminated = true,
     };
 
+    assert(arrlenu(context->internedStrings) < UINT32_MAX);
+    layec_symbol newSymbol = cast(layec_symbol) arrlenu(context->internedStrings);
     arrpush(context->internedStrings, newIntern);
-    return newIntern;
+    arrpush(context->internedHashes, hash);
+    context->internSlots[slot] = newSymbol + 1;
+
+    return newSymbol;
 }
 
-string layec_intern_location_text(layec_context* context, layec_location location)
+layec_symbol layec_intern_symbol(layec_context* context, string_view view)
 {
     assert(context != nullptr);
 
-    if (location.length == 0)
+    u64 hash = string_view_hash(view);
+
+    mutex_lock(context->internMutex);
+    layec_symbol symbol = intern_view_locked(context, view, hash);
+    mutex_unlock(context->internMutex);
+
+    return symbol;
+}
+
+layec_symbol layec_intern_location_symbol(layec_context* context, layec_location location)
+{
+    assert(context != nullptr);
+    return layec_intern_symbol(context, layec_view_from_location(context, location));
+}
+
+string layec_symbol_name(layec_context* context, layec_symbol symbol)
+{
+    assert(context != nullptr);
+
+    mutex_lock(context->internMutex);
+    assert(symbol < arrlenu(context->internedStrings));
+    string result = context->internedStrings[symbol];
+    mutex_unlock(context->internMutex);
+
+    return result;
+}
+
+string layec_intern_string_view(layec_context* context, string_view view)
+{
+    assert(context != nullptr);
+
+    if (view.count == 0)
         return (string){ .memory = cast(const uchar*) "<empty>", .allocator = nullptr, .count = 7 };
 
-    string sourceText = layec_context_get_file_source(context, location.fileId);
-    const char* locationText = cast(const char*)(sourceText.memory + location.offset);
+    u64 hash = string_view_hash(view);
 
-    usize internCount = arrlenu(context->internedStrings);
-    for (usize i = 0; i < internCount; i++)
-    {
-        string s = context->internedStrings[i];
-        if (s.count != location.length)
-            continue;
+    mutex_lock(context->internMutex);
+    layec_symbol symbol = intern_view_locked(context, view, hash);
+    string result = context->internedStrings[symbol];
+    mutex_unlock(context->internMutex);
 
-        if (0 == strncmp(locationText, cast(const char*) s.memory, location.length))
-        {
-            return s;
-        }
-    }
+    return result;
+}
 
-    uchar* newMemory = arena_push(context->stringArena, location.length + 1);
-    memcpy(newMemory, locationText, location.length);
-    newMemory[location.length] = 0;
+string layec_intern_location_text(layec_context* context, layec_location location)
+{
+    assert(context != nullptr);
 
-    string newIntern = {
-        .allocator = nullptr,
-        .count = location.length,
-        .memory = newMemory,
-        .isNulTerminated = true,
-    };
+    if (location.length == 0)
+        return (string){ .memory = cast(const uchar*) "<empty>", .allocator = nullptr, .count = 7 };
 
-    arrpush(context->internedStrings, newIntern);
-    return newIntern;
+    return layec_intern_string_view(context, layec_view_from_location(context, location));
 }
 
 EXT_FORMAT(4, 5)
@@ -269,91 +880,418 @@ void layec_issue_diagnostic(layec_context* context, layec_diagnostic_severity se
     va_end(ap);
 }
     
-void layec_vissue_diagnostic(layec_context* context, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap)
+static THREAD_LOCAL layec_diagnostic_capture* currentDiagnosticCapture = nullptr;
+
+void layec_set_diagnostic_capture(layec_diagnostic_capture* capture)
+{
+    currentDiagnosticCapture = capture;
+}
+
+layec_diagnostic_capture* layec_get_diagnostic_capture(void)
+{
+    return currentDiagnosticCapture;
+}
+
+static void capture_diagnostic(layec_diagnostic_capture* capture, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap)
+{
+    va_list lengthAp;
+    va_copy(lengthAp, ap);
+    int messageLength = vsnprintf(nullptr, 0, fmt, lengthAp);
+    va_end(lengthAp);
+
+    char* message = nullptr;
+    if (messageLength >= 0)
+    {
+        message = allocate(default_allocator, cast(usize) messageLength + 1);
+        vsnprintf(message, cast(usize) messageLength + 1, fmt, ap);
+    }
+    else
+    {
+        // the message can't be formatted, e.g. a rune without a representation in the current locale,
+        // so the format text itself is kept rather than losing the diagnostic.
+        messageLength = cast(int) strlen(fmt);
+        message = allocate(default_allocator, cast(usize) messageLength + 1);
+        memcpy(message, fmt, cast(usize) messageLength + 1);
+    }
+
+    layec_captured_diagnostic diagnostic = {
+        .severity = severity,
+        .location = loc,
+        .message = {
+            .allocator = default_allocator,
+            .memory = cast(const uchar*) message,
+            .count = cast(usize) messageLength,
+            .isNulTerminated = true,
+        },
+    };
+
+    arrput(capture->diagnostics, diagnostic);
+    if (severity >= SEV_ERROR)
+        capture->errorCount++;
+}
+
+void layec_replay_diagnostics(layec_context* context, layec_diagnostic_capture* capture)
+{
+    assert(capture != nullptr);
+
+    layec_replay_diagnostics_prefix(context, capture, arrlenu(capture->diagnostics));
+    arrfree(capture->diagnostics);
+}
+
+void layec_replay_diagnostics_prefix(layec_context* context, layec_diagnostic_capture* capture, usize count)
 {
     assert(context != nullptr);
-    assert(fmt != nullptr);
-    assert(severity >= 0 && severity < SEV_COUNT);
-    if (severity >= SEV_ERROR) context->hasIssuedHighSeverityDiagnostic = true;
+    assert(capture != nullptr);
+    assert(count <= arrlenu(capture->diagnostics));
+
+    for (usize i = 0; i < count; i++)
+    {
+        layec_captured_diagnostic diagnostic = capture->diagnostics[i];
+        layec_issue_diagnostic(context, diagnostic.severity, diagnostic.location, "%s", cast(const char*) diagnostic.message.memory);
+        string_deallocate(diagnostic.message);
 
-    string source = layec_context_get_file_source(context, loc.fileId);
-    string_view fileName = layec_context_get_file_name(context, loc.fileId);
+        if (diagnostic.severity >= SEV_ERROR)
+            capture->errorCount--;
+    }
 
-    static bool isFirstDiagnostic = true;
-    if (isFirstDiagnostic)
-        isFirstDiagnostic = false;
-    else fprintf(stderr, "\n");
+    if (count != 0)
+        arrdeln(capture->diagnostics, 0, count);
+}
+
+void layec_discard_diagnostics(layec_diagnostic_capture* capture)
+{
+    assert(capture != nullptr);
 
-    if (source.memory && source.count)
+    for (usize i = 0; i < arrlenu(capture->diagnostics); i++)
+        string_deallocate(capture->diagnostics[i].message);
+
+    arrfree(capture->diagnostics);
+    capture->errorCount = 0;
+}
+
+// appends the source between `start` and `end`, expanding tabs to four spaces.
+static void append_source_text(string_builder* sb, string source, usize start, usize end)
+{
+    usize runStart = start;
+    for (usize i = start; i < end; i++)
     {
-        if (loc.offset > source.count)
-            loc.offset = source.count;
-        if (loc.offset + loc.length > source.count)
-            loc.length = source.count - loc.offset;
+        if (source.memory[i] != '\t')
+            continue;
 
-        u32 lineNumber, lineStartOffset, lineEndOffset;
-        get_line_from_source(source, loc, &lineNumber, &lineStartOffset, &lineEndOffset);
+        string_builder_append_view(sb, string_slice(source, runStart, i - runStart));
+        string_builder_append_repeat(sb, ' ', 4);
+        runStart = i + 1;
+    }
 
-        if (loc.offset + loc.length > lineEndOffset)
-            loc.length = lineEndOffset - loc.offset;
+    string_builder_append_view(sb, string_slice(source, runStart, end - runStart));
+}
 
-        fprintf(stderr, STRING_VIEW_FORMAT ":%u:%zu: %s%s" ANSI_COLOR_RESET ": ", STRING_VIEW_EXPAND(fileName), lineNumber, 1 + loc.offset - lineStartOffset, severityColors[severity], severityNames[severity]);
-        vfprintf(stderr, fmt, ap);
+// appends `fill` once for every byte of the source between `start` and `end`, so it lines up with `append_source_text`.
+static void append_source_fill(string_builder* sb, string source, usize start, usize end, uchar fill)
+{
+    usize width = 0;
+    for (usize i = start; i < end; i++)
+        width += source.memory[i] == '\t' ? 4 : 1;
 
-        if (loc.length != 0)
-        {
-            fprintf(stderr, "\n %u | ", lineNumber);
-            for (u32 i = lineStartOffset; i < loc.offset; i++)
-            {
-                if (source.memory[i] == '\t')
-                    fprintf(stderr, "    ");
-                else fputc(source.memory[i], stderr);
-            }
+    string_builder_append_repeat(sb, fill, width);
+}
 
-            fprintf(stderr, "%s", severityColors[severity]);
-            for (u32 i = loc.offset; i < loc.offset + loc.length; i++)
-            {
-                if (source.memory[i] == '\t')
-                    fprintf(stderr, "    ");
-                else fputc(source.memory[i], stderr);
-            }
-            fprintf(stderr, ANSI_COLOR_RESET);
-            
-            for (u32 i = loc.offset + loc.length; i < lineEndOffset; i++)
-            {
-                if (source.memory[i] == '\t')
-                    fprintf(stderr, "    ");
-                else fputc(source.memory[i], stderr);
-            }
+static usize decimal_digit_count(usize value)
+{
+    usize digitCount = 1;
+    while (value >= 10)
+    {
+        value /= 10;
+        digitCount++;
+    }
 
-            fputc('\n', stderr);
+    return digitCount;
+}
 
-            usize nSpaces = log10(lineNumber) + 1;
-            for (usize i = 0; i < nSpaces; i++)
-                fputc(' ', stderr);
-            fprintf(stderr, "  | %s", severityColors[severity]);
-            for (u32 i = lineStartOffset; i < loc.offset; i++)
-            {
-                if (source.memory[i] == '\t')
-                    fprintf(stderr, "    ");
-                else fputc(' ', stderr);
-            }
+// the parts of a diagnostic every format reports.
+typedef struct rendered_location
+{
+    string_view fileName;
+    // false for diagnostics which aren't in any source, only `fileName` is set for them.
+    bool hasSource;
+    string source;
+    usize offset, length;
+    u32 lineNumber, lineStartOffset, lineEndOffset;
+} rendered_location;
+
+static rendered_location render_location(layec_context* context, layec_location loc)
+{
+    rendered_location result = { 0 };
+
+    layec_fileid fileId = layec_context_decode_location(context, loc, &result.offset);
+    result.length = loc.length;
+    result.source = layec_context_get_file_source(context, fileId);
+    // diagnostics without a location come from the compiler itself.
+    result.fileName = fileId == 0 ? STRING_VIEW_LITERAL("layec") : layec_context_get_file_name(context, fileId);
+
+    if (!result.source.memory || !result.source.count)
+        return result;
+
+    result.hasSource = true;
+
+    if (result.offset > result.source.count)
+        result.offset = result.source.count;
+    if (result.offset + result.length > result.source.count)
+        result.length = result.source.count - result.offset;
+
+    layec_context_get_line_info(context, fileId, result.offset, &result.lineNumber, &result.lineStartOffset, &result.lineEndOffset);
+
+    if (result.offset + result.length > result.lineEndOffset)
+        result.length = result.lineEndOffset - result.offset;
+
+    return result;
+}
+
+static void render_text_diagnostic(layec_context* context, string_builder* sb, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap)
+{
+    rendered_location location = render_location(context, loc);
+    const char* severityColor = severityColors[severity];
+
+    string_builder_append_view(sb, location.fileName);
+
+    if (!location.hasSource)
+    {
+        string_builder_append_format(sb, ": %s%s" ANSI_COLOR_RESET ": ", severityColor, severityNames[severity]);
+        string_builder_append_vformat(sb, fmt, ap);
+        string_builder_append_cstring(sb, "\n");
+        return;
+    }
+
+    string source = location.source;
+    usize offset = location.offset;
+    usize length = location.length;
+    u32 lineNumber = location.lineNumber;
+
+    string_builder_append_format(sb, ":%u:%zu: %s%s" ANSI_COLOR_RESET ": ", lineNumber, 1 + offset - location.lineStartOffset, severityColor, severityNames[severity]);
+    string_builder_append_vformat(sb, fmt, ap);
+
+    if (length != 0)
+    {
+        string_builder_append_format(sb, "\n %u | ", lineNumber);
+        append_source_text(sb, source, location.lineStartOffset, offset);
+        string_builder_append_cstring(sb, severityColor);
+        append_source_text(sb, source, offset, offset + length);
+        string_builder_append_cstring(sb, ANSI_COLOR_RESET);
+        append_source_text(sb, source, offset + length, location.lineEndOffset);
+        string_builder_append_cstring(sb, "\n");
+
+        string_builder_append_repeat(sb, ' ', decimal_digit_count(lineNumber));
+        string_builder_append_cstring(sb, "  | ");
+        string_builder_append_cstring(sb, severityColor);
+        append_source_fill(sb, source, location.lineStartOffset, offset, ' ');
+        append_source_fill(sb, source, offset, offset + length, '~');
+        string_builder_append_cstring(sb, ANSI_COLOR_RESET);
+    }
+
+    string_builder_append_cstring(sb, "\n");
+}
+
+static string_view format_diagnostic_message(layec_context* context, const char* fmt, va_list ap)
+{
+    string_builder* messageBuilder = &context->diagnosticMessageBuilder;
+    string_builder_set_count(messageBuilder, 0);
+    string_builder_append_vformat(messageBuilder, fmt, ap);
+    return (string_view){ messageBuilder->memory, messageBuilder->count };
+}
+
+static const char* jsonSeverityNames[SEV_COUNT] = {
+    "info",
+    "warning",
+    "error",
+    "ice",
+    "sorry",
+};
+
+static void render_json_diagnostic(layec_context* context, string_builder* sb, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap)
+{
+    rendered_location location = render_location(context, loc);
+
+    string_builder_append_cstring(sb, "{\"file\":");
+    layec_append_json_string(sb, location.fileName);
+
+    if (location.hasSource)
+    {
+        string_builder_append_format(sb, ",\"line\":%u,\"column\":%zu,\"length\":%zu", location.lineNumber,
+            1 + location.offset - location.lineStartOffset, location.length);
+    }
+
+    string_builder_append_format(sb, ",\"severity\":\"%s\",\"message\":", jsonSeverityNames[severity]);
+    layec_append_json_string(sb, format_diagnostic_message(context, fmt, ap));
+    string_builder_append_cstring(sb, "}\n");
+}
+
+static const char* sarifLevelNames[SEV_COUNT] = {
+    "note",
+    "warning",
+    "error",
+    "error",
+    "error",
+};
+
+static void render_sarif_diagnostic(layec_context* context, string_builder* sb, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap)
+{
+    rendered_location location = render_location(context, loc);
+
+    string_builder_append_format(sb, "{\"level\":\"%s\",\"message\":{\"text\":", sarifLevelNames[severity]);
+    layec_append_json_string(sb, format_diagnostic_message(context, fmt, ap));
+    string_builder_append_cstring(sb, "}");
+
+    if (location.hasSource)
+    {
+        // columns are counted in bytes, as they are everywhere else in the compiler.
+        usize startColumn = 1 + location.offset - location.lineStartOffset;
+        string_builder_append_cstring(sb, ",\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+        layec_append_json_string(sb, location.fileName);
+        string_builder_append_format(sb, "},\"region\":{\"startLine\":%u,\"startColumn\":%zu,\"endColumn\":%zu}}}]",
+            location.lineNumber, startColumn, startColumn + location.length);
+    }
+
+    string_builder_append_cstring(sb, "}");
+}
+
+static const char sarifLogStart[] = "{\"version\":\"2.1.0\",\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+    "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"layec\"}},\"results\":[\n";
+static const char sarifLogEnd[] = "\n]}]}\n";
+
+// renders a diagnostic into `diagnosticBuilder` after the ones before it, `diagnosticMutex` must be held.
+static void render_diagnostic_locked(layec_context* context, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap)
+{
+    string_builder* sb = &context->diagnosticBuilder;
+
+    switch (context->diagnosticFormat)
+    {
+        case LAYEC_DIAGNOSTIC_FORMAT_TEXT:
+        {
+            // text diagnostics are separated by a blank line.
+            if (context->reportedDiagnosticCount > 0)
+                string_builder_append_cstring(sb, "\n");
+            render_text_diagnostic(context, sb, severity, loc, fmt, ap);
+        } break;
 
-            for (u32 i = loc.offset; i < loc.offset + loc.length; i++)
+        case LAYEC_DIAGNOSTIC_FORMAT_JSON:
+        {
+            render_json_diagnostic(context, sb, severity, loc, fmt, ap);
+        } break;
+
+        case LAYEC_DIAGNOSTIC_FORMAT_SARIF:
+        {
+            if (!context->hasStartedDiagnosticLog)
             {
-                if (source.memory[i] == '\t')
-                    fprintf(stderr, "~~~~");
-                else fputc('~', stderr);
+                string_builder_append_cstring(sb, sarifLogStart);
+                context->hasStartedDiagnosticLog = true;
             }
-            fprintf(stderr, ANSI_COLOR_RESET);
-        }
+            else if (context->reportedDiagnosticCount > 0)
+                string_builder_append_cstring(sb, ",\n");
+            render_sarif_diagnostic(context, sb, severity, loc, fmt, ap);
+        } break;
     }
-    else
+
+    context->reportedDiagnosticCount++;
+}
+
+static void render_diagnosticf_locked(layec_context* context, layec_diagnostic_severity severity, layec_location loc, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    render_diagnostic_locked(context, severity, loc, fmt, ap);
+    va_end(ap);
+}
+
+// writes the rendered diagnostics in one go, `diagnosticMutex` must be held.
+static void flush_diagnostics_locked(layec_context* context)
+{
+    string_builder* sb = &context->diagnosticBuilder;
+    if (sb->count == 0)
+        return;
+
+    fwrite(sb->memory, 1, sb->count, stderr);
+    fflush(stderr);
+    string_builder_set_count(sb, 0);
+}
+
+void layec_flush_diagnostics(layec_context* context)
+{
+    assert(context != nullptr);
+
+    mutex_lock(context->diagnosticMutex);
+    flush_diagnostics_locked(context);
+    mutex_unlock(context->diagnosticMutex);
+}
+
+// completes the diagnostic output, which for a SARIF log means closing it even if nothing was reported.
+static void finish_diagnostics(layec_context* context)
+{
+    mutex_lock(context->diagnosticMutex);
+
+    if (context->diagnosticFormat == LAYEC_DIAGNOSTIC_FORMAT_SARIF)
     {
-        fprintf(stderr, STRING_VIEW_FORMAT ": %s%s" ANSI_COLOR_RESET ": ", STRING_VIEW_EXPAND(fileName), severityColors[severity], severityNames[severity]);
-        vfprintf(stderr, fmt, ap);
+        if (!context->hasStartedDiagnosticLog)
+            string_builder_append_cstring(&context->diagnosticBuilder, sarifLogStart);
+        string_builder_append_cstring(&context->diagnosticBuilder, sarifLogEnd);
+        context->hasStartedDiagnosticLog = false;
     }
 
-    fputc('\n', stderr);
+    flush_diagnostics_locked(context);
+    mutex_unlock(context->diagnosticMutex);
 }
 
+bool layec_error_limit_reached(layec_context* context)
+{
+    assert(context != nullptr);
+
+    if (context->errorLimit == 0)
+        return false;
+
+    if (currentDiagnosticCapture != nullptr)
+        return currentDiagnosticCapture->errorCount >= context->errorLimit;
+
+    mutex_lock(context->diagnosticMutex);
+    bool isLimitReached = context->reportedErrorCount >= context->errorLimit;
+    mutex_unlock(context->diagnosticMutex);
+
+    return isLimitReached;
+}
+
+void layec_vissue_diagnostic(layec_context* context, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap)
+{
+    assert(context != nullptr);
+    assert(fmt != nullptr);
+    assert(severity >= 0 && severity < SEV_COUNT);
+
+    if (currentDiagnosticCapture != nullptr)
+    {
+        capture_diagnostic(currentDiagnosticCapture, severity, loc, fmt, ap);
+        return;
+    }
+
+    if (severity >= SEV_ERROR) context->hasIssuedHighSeverityDiagnostic = true;
+
+    mutex_lock(context->diagnosticMutex);
+
+    bool isError = severity >= SEV_ERROR;
+    if (isError && context->errorLimit != 0 && context->reportedErrorCount >= context->errorLimit)
+    {
+        // past the limit errors are dropped, they'd most likely be cascading from earlier ones anyway.
+        mutex_unlock(context->diagnosticMutex);
+        return;
+    }
+
+    render_diagnostic_locked(context, severity, loc, fmt, ap);
+
+    if (isError)
+    {
+        context->reportedErrorCount++;
+        if (context->reportedErrorCount == context->errorLimit)
+            render_diagnosticf_locked(context, SEV_ERROR, (layec_location){ 0 }, "Too many errors emitted, stopping after %zu.", context->errorLimit);
+    }
+
+    if (!context->batchDiagnostics)
+        flush_diagnostics_locked(context);
+
+    mutex_unlock(context->diagnosticMutex);
+}
@@ -2,10 +2,8 @@
 
 layec_location layec_location_combine(layec_location a, layec_location b)
 {
-    assert(a.fileId == b.fileId);
-
-    usize startOffset = 0;
-    usize endOffset = 0;
+    u32 startOffset = 0;
+    u32 endOffset = 0;
 
     if (a.offset < b.offset)
     {
@@ -19,7 +17,6 @@ layec_location layec_location_combine(layec_location a, layec_location b)
     }
 
     return (layec_location){
-        .fileId = a.fileId,
         .offset = startOffset,
         .length = endOffset - startOffset,
     };
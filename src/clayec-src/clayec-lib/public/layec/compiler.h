@@ -2,37 +2,201 @@
 #define LAYEC_COMPILER_H
 
 #include "kos/kos.h"
+#include "kos/platform.h"
+#include "kos/thread.h"
+
+#include <stdio.h>
 
 #include "layec/diagnostic.h"
 
+// a name interned in the context, see `layec_intern_symbol`.
+typedef u32 layec_symbol;
+
 typedef struct layec_source_file_info
 {
     string_view name;
     string_view fullPath;
     string source;
+    // where the file's span of the location offset space starts, see `layec_location`.
+    u32 baseOffset;
+    // true if the context read `source` itself and has to release it.
+    bool ownsSource;
+    // the offset of the first byte of each line, built the first time it's needed.
+    list(u32) lineStarts;
 } layec_source_file_info;
 
+// the combined statistics of every arena recorded under one tag.
+typedef struct layec_memory_usage
+{
+    const char* tag;
+    usize arenaCount;
+    kos_arena_stats stats;
+} layec_memory_usage;
+
+typedef enum layec_ast_dump_format
+{
+    // the tree isn't printed at all.
+    LAYEC_AST_DUMP_FORMAT_NONE,
+    // an indented, colored tree.
+    LAYEC_AST_DUMP_FORMAT_TEXT,
+    // one JSON object per line for each file.
+    LAYEC_AST_DUMP_FORMAT_JSON,
+} layec_ast_dump_format;
+
+// the combined times of every scope timed under one phase for one file, see `layec_timer_begin`.
+typedef struct layec_time_usage
+{
+    const char* phase;
+    // 0 for phases which aren't about any one file.
+    layec_fileid fileId;
+    usize count;
+    u64 totalNanoseconds;
+    // the total less the time spent in scopes nested in these ones.
+    u64 selfNanoseconds;
+} layec_time_usage;
+
+// a timed region of the compiler. scopes on one thread nest, and must end in the reverse order they began.
+typedef struct layec_timer_scope layec_timer_scope;
+struct layec_timer_scope
+{
+    // nullptr if the scope isn't being timed.
+    const char* phase;
+    layec_fileid fileId;
+    u64 startNanoseconds;
+    u64 childNanoseconds;
+    layec_timer_scope* parent;
+};
+
+// one timed scope as it's written to a trace, see `layec_context_write_trace`.
+typedef struct layec_trace_event
+{
+    const char* phase;
+    layec_fileid fileId;
+    // numbered from 1 in the order threads first end a scope, not the operating system's id.
+    u32 threadId;
+    // relative to `traceStartNanoseconds`.
+    u64 startNanoseconds;
+    u64 durationNanoseconds;
+} layec_trace_event;
+
 typedef struct layec_context
 {
     bool verbose;
+    // the number of threads front ends may parse with, 0 and 1 both mean a single thread.
+    usize jobCount;
     bool hasIssuedHighSeverityDiagnostic;
+    // true if arena statistics are recorded for a memory report.
+    bool memoryReport;
+    // true if phases are timed for a time report.
+    bool timeReport;
+    // true if every timed scope is kept as an event for a trace.
+    bool trace;
+    // how front ends print the trees they parse, to stdout.
+    layec_ast_dump_format astDumpFormat;
+    // the directory front ends cache the trees they parse in, keyed by the hash of each file's source.
+    // empty if trees aren't cached.
+    string_view astCacheDirectory;
+    // guards `files`, both file indices, `threadConstantArenas`, `memoryUsage`, `timeUsage` and every trace field,
+    // which may be added to while other threads are reading them.
+    kos_mutex* filesMutex;
     list(layec_source_file_info) files;
+    // the base offset of the next file added, file spans are laid out in the order files are added.
+    u32 nextBaseOffset;
+    // maps every path a file was requested by, and the name of every file added with its source, to its file id.
+    strmap(layec_fileid) filePathIndex;
+    // maps the identity of every file read from disk to its file id, so each link or spelling of a path shares one id.
+    hashmap(platform_file_identity, layec_fileid) fileIdentityIndex;
+    // guards the string arena and every interning table below.
+    kos_mutex* internMutex;
     arena_allocator* stringArena;
+    // every interned string, indexed by its symbol.
     list(string) internedStrings;
+    // the hash of each interned string, indexed by its symbol.
+    list(u64) internedHashes;
+    // open addressing table over `internedStrings`, each slot stores a symbol + 1 or 0 if empty.
+    u32* internSlots;
+    usize internSlotCount;
     arena_allocator* constantArena;
+    // constant arenas handed out to threads other than the main one, see `layec_context_create_constant_arena`.
+    list(arena_allocator*) threadConstantArenas;
+    // statistics of arenas which have been destroyed, see `layec_context_record_arena`.
+    list(layec_memory_usage) memoryUsage;
+    // the times of every phase, see `layec_timer_begin`.
+    list(layec_time_usage) timeUsage;
+    // when the context was created, trace events are timed from here.
+    u64 traceStartNanoseconds;
+    u32 traceThreadCount;
+    list(layec_trace_event) traceEvents;
+    // guards every diagnostic field below.
+    kos_mutex* diagnosticMutex;
+    layec_diagnostic_format diagnosticFormat;
+    // true if rendered diagnostics are kept until `layec_flush_diagnostics` rather than written as they're issued.
+    bool batchDiagnostics;
+    // the number of errors after which no more are reported and front ends stop, 0 for no limit.
+    // each file is parsed up to the limit on its own, so the same files stop at the same point whatever the
+    // number of threads; the limit on what's reported covers every file together.
+    usize errorLimit;
+    // the number of diagnostics reported, not counting ones which are captured.
+    usize reportedDiagnosticCount;
+    usize reportedErrorCount;
+    // true once the start of a SARIF log has been written.
+    bool hasStartedDiagnosticLog;
+    // diagnostics are rendered here so each one, or each batch, is a single write.
+    string_builder diagnosticBuilder;
+    // holds the formatted message of a diagnostic while it's escaped into `diagnosticBuilder`.
+    string_builder diagnosticMessageBuilder;
 } layec_context;
 
 void layec_context_init(layec_context* context);
+// releases every file source and arena the context owns.
+void layec_context_deinit(layec_context* context);
+// creates an arena for constant data which lives as long as the context.
+// `constantArena` belongs to the main thread, every other thread needs its own arena from here.
+arena_allocator* layec_context_create_constant_arena(layec_context* context);
+// adds the statistics of an arena about to be destroyed to those recorded under `tag`, if a memory report was asked for.
+void layec_context_record_arena(layec_context* context, const char* tag, arena_allocator* arena);
+void layec_context_record_memory_usage(layec_context* context, const char* tag, kos_arena_stats stats);
+// prints the recorded statistics along with those of the arenas the context still owns.
+void layec_context_print_memory_report(layec_context* context, FILE* stream);
+
+// starts timing `phase` on the calling thread, if a time report or trace was asked for. `phase` must outlive the context.
+void layec_timer_begin(layec_context* context, layec_timer_scope* scope, const char* phase, layec_fileid fileId);
+void layec_timer_end(layec_context* context, layec_timer_scope* scope);
+// records time measured some other way, as if it were a scope nested in the calling thread's current one.
+// the time has no start of its own, so it's left out of traces.
+void layec_timer_record(layec_context* context, const char* phase, layec_fileid fileId, u64 nanoseconds);
+// prints the recorded times of each phase, then of each phase for each file.
+void layec_context_print_time_report(layec_context* context, FILE* stream);
+// writes every trace event to `path` in the Chrome trace event format, returns false if the file can't be written.
+bool layec_context_write_trace(layec_context* context, const char* path);
 
 layec_fileid layec_context_add_file(layec_context* context, string_view name, string_view relativeTo);
 layec_fileid layec_context_add_file_with_source(layec_context* context, string_view name, string source);
 string_view layec_context_get_file_name(layec_context* context, layec_fileid fileId);
 string_view layec_context_get_file_full_path(layec_context* context, layec_fileid fileId);
 string layec_context_get_file_source(layec_context* context, layec_fileid fileId);
+// where the span of a file starts, the location of the file's byte at `n` has offset `base + n`.
+u32 layec_context_get_file_base_offset(layec_context* context, layec_fileid fileId);
+// finds the file a location is in, and the location's offset from the start of that file.
+// returns 0 for an empty location.
+layec_fileid layec_context_decode_location(layec_context* context, layec_location loc, usize* outFileOffset);
+// finds the 1-based number of the line containing `offset`, and the offsets that line starts and ends at.
+// the end offset is that of the line's '\n', or the length of the source for the last line.
+void layec_context_get_line_info(layec_context* context, layec_fileid fileId, usize offset,
+    u32* lineNumber, u32* lineStartOffset, u32* lineEndOffset);
 
 string_view layec_view_from_location(layec_context* context, layec_location loc);
 string layec_intern_string_view(layec_context* context, string_view view);
 string layec_intern_location_text(layec_context* context, layec_location location);
+// returns the symbol of the interned view, its index into `internedStrings`.
+// symbols are dense and start from 0, which is always the empty name, so a zeroed symbol is an empty name.
+layec_symbol layec_intern_symbol(layec_context* context, string_view view);
+layec_symbol layec_intern_location_symbol(layec_context* context, layec_location location);
+// the text of a symbol, which lives as long as the context.
+string layec_symbol_name(layec_context* context, layec_symbol symbol);
+
+// appends `value` as a quoted JSON string, escaping whatever JSON requires.
+void layec_append_json_string(string_builder* sb, string_view value);
 
 EXT_FORMAT(4, 5)
 void layec_debugf(layec_context* context, const char* fmt, ...);
@@ -43,4 +207,22 @@ void layec_issue_diagnostic(layec_context* context, layec_diagnostic_severity se
     
 void layec_vissue_diagnostic(layec_context* context, layec_diagnostic_severity severity, layec_location loc, const char* fmt, va_list ap);
 
+// writes every diagnostic rendered so far, see `batchDiagnostics`.
+void layec_flush_diagnostics(layec_context* context);
+// true once the error limit has been reached. while a capture is set on the calling thread only the errors
+// it captured count, so a file parsed on any thread stops at the same point it would on its own.
+bool layec_error_limit_reached(layec_context* context);
+
+// while a capture is set, diagnostics issued on the calling thread are recorded into it instead of reported.
+// pass nullptr to report diagnostics directly again.
+void layec_set_diagnostic_capture(layec_diagnostic_capture* capture);
+// the capture set on the calling thread, nullptr if diagnostics are reported directly.
+layec_diagnostic_capture* layec_get_diagnostic_capture(void);
+// reports every captured diagnostic in the order it was issued, then empties the capture.
+void layec_replay_diagnostics(layec_context* context, layec_diagnostic_capture* capture);
+// reports the first `count` captured diagnostics in the order they were issued, then removes them from the capture.
+void layec_replay_diagnostics_prefix(layec_context* context, layec_diagnostic_capture* capture, usize count);
+// empties the capture without reporting anything it holds.
+void layec_discard_diagnostics(layec_diagnostic_capture* capture);
+
 #endif // LAYEC_COMPILER_H
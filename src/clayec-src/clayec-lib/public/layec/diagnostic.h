@@ -20,12 +20,39 @@ typedef enum layec_diagnostic_severity
     SEV_COUNT,
 } layec_diagnostic_severity;
 
+// a range of source text. every file added to a context is given its own span of one shared offset space,
+// so a location identifies its file without storing it, see `layec_context_decode_location`.
+// offset 0 is never part of a file, a zeroed location is no location at all.
 typedef struct layec_location
 {
-    layec_fileid fileId;
-    usize offset, length;
+    u32 offset, length;
 } layec_location;
 
+// a diagnostic which has been recorded instead of reported, to be reported later.
+typedef struct layec_captured_diagnostic
+{
+    layec_diagnostic_severity severity;
+    layec_location location;
+    string message;
+} layec_captured_diagnostic;
+
+typedef struct layec_diagnostic_capture
+{
+    list(layec_captured_diagnostic) diagnostics;
+    // the number of captured diagnostics which are errors or worse.
+    usize errorCount;
+} layec_diagnostic_capture;
+
+typedef enum layec_diagnostic_format
+{
+    // colored text meant for a terminal.
+    LAYEC_DIAGNOSTIC_FORMAT_TEXT,
+    // one JSON object per line for each diagnostic.
+    LAYEC_DIAGNOSTIC_FORMAT_JSON,
+    // a single SARIF 2.1.0 log, which is closed when the context is deinitialized.
+    LAYEC_DIAGNOSTIC_FORMAT_SARIF,
+} layec_diagnostic_format;
+
 layec_location layec_location_combine(layec_location a, layec_location b);
 bool layec_location_immediately_follows(layec_location a, layec_location b);
 
@@ -71,8 +71,8 @@ struct lyir_type
     {
         struct
         {
-            // the name of this struct; should assert that is is nul terminated
-            string name;
+            // the name of this struct, interned in the module's context.
+            layec_symbol name;
             list(lyir_type*) fieldTypes;
             list(lyir_type*) variantTypes;
         } _struct;
@@ -104,8 +104,8 @@ typedef struct lyir_symbol_flags
 
 typedef struct lyir_symbol
 {
-    // the name of this symbol; should assert that is is nul terminated
-    string name;
+    // the name of this symbol, interned in the module's context.
+    layec_symbol name;
     lyir_symbol_flags flags;
     lyir_type* type;
 } lyir_symbol;
@@ -129,12 +129,12 @@ typedef struct lyir_block lyir_block;
 typedef struct lyir_op
 {
     lyir_op_kind kind;
-    string name;
+    layec_symbol name;
 } lyir_op;
 
 struct lyir_block
 {
-    string name;
+    layec_symbol name;
     list(lyir_op*) ops;
 };
 
@@ -155,11 +155,12 @@ typedef struct lyir_module
     layec_context* context;
 
     arena_allocator* symbolArena;
-    strmap(lyir_symbol*) symbols;
+    // keyed by symbol name.
+    hashmap(layec_symbol, lyir_symbol*) symbols;
 
     arena_allocator* opsArena;
-    strmap(lyir_function) functions;
-    strmap(lyir_binding) globals;
+    hashmap(layec_symbol, lyir_function) functions;
+    hashmap(layec_symbol, lyir_binding) globals;
 } lyir_module;
 
 #endif // LAYE_LYIR_H
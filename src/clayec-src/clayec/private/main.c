@@ -1,9 +1,12 @@
 #include <assert.h>
+#include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "kos/args.h"
 #include "kos/kos.h"
 #include "kos/platform.h"
+#include "kos/thread.h"
 
 #include "layec/compiler.h"
 
@@ -22,6 +25,18 @@ typedef struct layec_args
     bool verbose;
     bool help;
     string_view outputFileName;
+    // the number of threads used to parse source files, 0 to use every available hardware thread.
+    usize jobCount;
+    bool memoryReport;
+    bool timeReport;
+    // the file a Chrome trace of every timed phase is written to, empty if none is.
+    string_view traceOutFileName;
+    bool batchDiagnostics;
+    layec_ast_dump_format astDumpFormat;
+    // the directory parsed trees are cached in, empty if they aren't.
+    string_view astCacheDirectory;
+    layec_diagnostic_format diagnosticFormat;
+    usize errorLimit;
     list(layec_file_info) files;
 } layec_args;
 
@@ -34,12 +49,44 @@ static arg_option options[] = {
     { "verbose", 0, nullptr, "Generate verbose output" },
     { "help", 0, nullptr, "Display this help message" },
     { "out", 'o', "file", "Write output to <file>" },
+    { "jobs", 'j', "count", "Parse source files on <count> threads, or one per hardware thread if 0" },
+    { "mem-report", 0, nullptr, "Print how much memory each kind of arena used" },
+    { "time-report", 0, nullptr, "Print how long each compilation phase took, in total and for each file" },
+    { "trace-out", 0, "file", "Write a Chrome trace of each compilation phase on each thread to <file>" },
+    { "dump-ast", 0, nullptr, "Print the tree of each parsed file to stdout, as text or as json if given --dump-ast=json" },
+    { "ast-cache", 0, "dir", "Cache the tree of each parsed file in <dir>, and load it from there while the file is unchanged" },
+    { "batch-diagnostics", 0, nullptr, "Write diagnostics once each compilation phase ends instead of as they are issued" },
+    { "diagnostic-format", 0, "format", "Write diagnostics as <format>, one of text (the default), json or sarif" },
+    { "error-limit", 0, "count", "Stop once <count> errors have been reported in total, or never if 0; each file is parsed until it has <count> errors of its own" },
     { 0    , 'x', "language", "Treat the subsequent input files as having type <language>" },
     { 0 },
 };
 
 static args_parser parser = { options, layec_args_parser, layec_desc, layec_usage };
 
+static bool parse_usize_argument(string_view value, usize* result)
+{
+    if (value.count == 0)
+        return false;
+
+    usize accumulator = 0;
+    for (usize i = 0; i < value.count; i++)
+    {
+        uchar c = value.memory[i];
+        if (c < '0' || c > '9')
+            return false;
+
+        // a count too large to hold is as invalid as one which isn't a number.
+        if (accumulator > (cast(usize) -1 - cast(usize) (c - '0')) / 10)
+            return false;
+
+        accumulator = accumulator * 10 + cast(usize) (c - '0');
+    }
+
+    *result = accumulator;
+    return true;
+}
+
 static args_parse_status layec_args_parser(arg_parsed arg, args_state* state)
 {
     static string_view overrideLanguage = { 0 };
@@ -58,6 +105,11 @@ static args_parse_status layec_args_parser(arg_parsed arg, args_state* state)
         switch (arg.shortOption)
         {
             case 'o': args->outputFileName = arg.value; break;
+            case 'j':
+            {
+                if (!parse_usize_argument(arg.value, &args->jobCount))
+                    return KOS_ARGS_PARSED_ERR_UNKNOWN;
+            } break;
             case 'x':
             {
                 if (string_view_equals_constant(arg.value, "auto"))
@@ -75,6 +127,52 @@ static args_parse_status layec_args_parser(arg_parsed arg, args_state* state)
             args->help = true;
         else if (string_view_equals_constant(arg.longOption, "out"))
             args->outputFileName = arg.value;
+        else if (string_view_equals_constant(arg.longOption, "jobs"))
+        {
+            if (!parse_usize_argument(arg.value, &args->jobCount))
+                return KOS_ARGS_PARSED_ERR_UNKNOWN;
+        }
+        else if (string_view_equals_constant(arg.longOption, "mem-report"))
+            args->memoryReport = true;
+        else if (string_view_equals_constant(arg.longOption, "time-report"))
+            args->timeReport = true;
+        else if (string_view_equals_constant(arg.longOption, "trace-out"))
+        {
+            if (arg.value.count == 0)
+                return KOS_ARGS_PARSED_ERR_UNKNOWN;
+            args->traceOutFileName = arg.value;
+        }
+        else if (string_view_equals_constant(arg.longOption, "dump-ast"))
+        {
+            if (arg.value.count == 0 || string_view_equals_constant(arg.value, "text"))
+                args->astDumpFormat = LAYEC_AST_DUMP_FORMAT_TEXT;
+            else if (string_view_equals_constant(arg.value, "json"))
+                args->astDumpFormat = LAYEC_AST_DUMP_FORMAT_JSON;
+            else return KOS_ARGS_PARSED_ERR_UNKNOWN;
+        }
+        else if (string_view_equals_constant(arg.longOption, "ast-cache"))
+        {
+            if (arg.value.count == 0)
+                return KOS_ARGS_PARSED_ERR_UNKNOWN;
+            args->astCacheDirectory = arg.value;
+        }
+        else if (string_view_equals_constant(arg.longOption, "batch-diagnostics"))
+            args->batchDiagnostics = true;
+        else if (string_view_equals_constant(arg.longOption, "diagnostic-format"))
+        {
+            if (string_view_equals_constant(arg.value, "text"))
+                args->diagnosticFormat = LAYEC_DIAGNOSTIC_FORMAT_TEXT;
+            else if (string_view_equals_constant(arg.value, "json"))
+                args->diagnosticFormat = LAYEC_DIAGNOSTIC_FORMAT_JSON;
+            else if (string_view_equals_constant(arg.value, "sarif"))
+                args->diagnosticFormat = LAYEC_DIAGNOSTIC_FORMAT_SARIF;
+            else return KOS_ARGS_PARSED_ERR_UNKNOWN;
+        }
+        else if (string_view_equals_constant(arg.longOption, "error-limit"))
+        {
+            if (!parse_usize_argument(arg.value, &args->errorLimit))
+                return KOS_ARGS_PARSED_ERR_UNKNOWN;
+        }
         else return KOS_ARGS_PARSED_ERR_UNKNOWN;
     }
     
@@ -114,9 +212,28 @@ typedef struct front_end_data
     list(layec_fileid) files;
 } front_end_data;
 
+// reports an error of the driver itself. structured diagnostics are one document, so there it has to be
+// a diagnostic of its own rather than a line of text in the middle of them.
+EXT_FORMAT(2, 3)
+static void report_driver_error(layec_context* context, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+
+    if (context->diagnosticFormat == LAYEC_DIAGNOSTIC_FORMAT_TEXT)
+    {
+        fprintf(stderr, "layec: ");
+        vfprintf(stderr, fmt, ap);
+        fprintf(stderr, "\n");
+    }
+    else layec_vissue_diagnostic(context, SEV_ERROR, (layec_location){ 0 }, fmt, ap);
+
+    va_end(ap);
+}
+
 int main(int argc, char** argv)
 {
-    layec_args args = { 0 };
+    layec_args args = { .jobCount = 1 };
     args_parse(&parser, argc, argv, &args);
 
     if (args.verbose) debug_print_args(args);
@@ -124,6 +241,15 @@ int main(int argc, char** argv)
     layec_context context = { 0 };
     layec_context_init(&context);
     context.verbose = args.verbose;
+    context.jobCount = args.jobCount != 0 ? args.jobCount : thread_hardware_concurrency();
+    context.memoryReport = args.memoryReport;
+    context.timeReport = args.timeReport;
+    context.trace = args.traceOutFileName.count != 0;
+    context.astDumpFormat = args.astDumpFormat;
+    context.astCacheDirectory = args.astCacheDirectory;
+    context.batchDiagnostics = args.batchDiagnostics;
+    context.diagnosticFormat = args.diagnosticFormat;
+    context.errorLimit = args.errorLimit;
 
     list(front_end_data*) frontEndsToInvoke = nullptr;
 
@@ -135,8 +261,9 @@ int main(int argc, char** argv)
         layec_fileid fileId = layec_context_add_file(&context, fileInfo.fileName, STRING_VIEW_EMPTY);
         if (fileId == 0)
         {
-            fprintf(stderr, "Failed to read source file '"STRING_VIEW_FORMAT"'", STRING_VIEW_EXPAND(fileInfo.fileName));
-            return 0;
+            report_driver_error(&context, "failed to read source file '"STRING_VIEW_FORMAT"'", STRING_VIEW_EXPAND(fileInfo.fileName));
+            layec_context_deinit(&context);
+            return 1;
         }
 
         assert(fileId > 0);
@@ -184,7 +311,7 @@ int main(int argc, char** argv)
 
         if (!foundFrontEndForFile)
         {
-            fprintf(stderr, "layec: unable to determine suitable front end for file '" STRING_VIEW_FORMAT "'\n", STRING_VIEW_EXPAND(fileInfo.fileName));
+            report_driver_error(&context, "unable to determine suitable front end for file '" STRING_VIEW_FORMAT "'", STRING_VIEW_EXPAND(fileInfo.fileName));
         }
     }
 
@@ -194,18 +321,46 @@ int main(int argc, char** argv)
         front_end_data* frontEndData = frontEndsToInvoke[k];
         if (args.verbose) fprintf(stderr, "layec: invoking front end '%s'\n", frontEndData->name);
 
+        layec_timer_scope frontEndScope;
+        layec_timer_begin(&context, &frontEndScope, frontEndData->name, 0);
         layec_front_end_status status = frontEndData->entryFunction(&context, frontEndData->files);
+        layec_timer_end(&context, &frontEndScope);
+        layec_flush_diagnostics(&context);
+
+        if (layec_error_limit_reached(&context))
+        {
+            allFrontEndsSuccessfull = false;
+            break;
+        }
 
         if (status != LAYEC_FRONT_SUCCESS)
         {
-            fprintf(stderr, "Front end `%s` did not complete successfully\n", frontEndData->name);
+            // the diagnostics already say why, these summaries only go along with them as text.
+            if (args.diagnosticFormat == LAYEC_DIAGNOSTIC_FORMAT_TEXT)
+                fprintf(stderr, "Front end `%s` did not complete successfully\n", frontEndData->name);
             allFrontEndsSuccessfull = false;
         }
     }
 
+    if (args.memoryReport)
+        layec_context_print_memory_report(&context, stderr);
+    if (args.timeReport)
+        layec_context_print_time_report(&context, stderr);
+
+    if (context.trace)
+    {
+        const char* traceOutFileName = string_view_to_cstring(args.traceOutFileName, nullptr);
+        if (!layec_context_write_trace(&context, traceOutFileName))
+            report_driver_error(&context, "unable to write trace file '%s'", traceOutFileName);
+        deallocate(default_allocator, cast(void*) traceOutFileName);
+    }
+
+    layec_context_deinit(&context);
+
     if (!allFrontEndsSuccessfull)
     {
-        fprintf(stderr, "Not all front ends completed successfully, aborting compilation.\n");
+        if (args.diagnosticFormat == LAYEC_DIAGNOSTIC_FORMAT_TEXT)
+            fprintf(stderr, "Not all front ends completed successfully, aborting compilation.\n");
         return 1;
     }
 
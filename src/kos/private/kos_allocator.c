@@ -1,3 +1,10 @@
+#ifndef _WIN32
+#  include <sys/mman.h>
+#else
+#  define WIN32_LEAN_AND_MEAN
+#  include "Windows.h"
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -6,6 +13,11 @@
 #include "kos/builtins.h"
 #include "kos/allocator.h"
 
+// blocks double in size, starting from the arena's block size, until they reach this size.
+#define KOS_ARENA_MAX_GROWN_BLOCK_SIZE (1024 * 1024)
+// virtual arenas commit their reserved range in steps of this size, it's a multiple of every common page size.
+#define KOS_ARENA_VIRTUAL_COMMIT_SIZE (64 * 1024)
+
 typedef struct kos_arena_block
 {
     void* data;
@@ -16,9 +28,26 @@ typedef struct kos_arena_block
 struct kos_arena_allocator
 {
     kos_allocator_function baseAllocator;
+    // the last block is the one allocations are currently made from.
     kos_arena_block* blocks;
-    usize blockSize;
     usize blockCount;
+    usize blockCapacity;
+    // the size of the first block, pushes larger than this get a block of their own.
+    usize blockSize;
+    usize nextBlockSize;
+    // the dedicated blocks of oversized pushes.
+    kos_arena_block* largeBlocks;
+    usize largeBlockCount;
+    usize largeBlockCapacity;
+    // a virtual arena has exactly one block, its whole reserved address range, which is committed as it fills.
+    bool isVirtual;
+    usize committedSize;
+    // see kos_arena_stats.
+    usize pushCount;
+    usize requestedBytes;
+    usize committedBytes;
+    usize peakCommittedBytes;
+    usize wastedBytes;
 };
 
 void* kos_default_allocator(kos_allocator_action action, void* memory, usize count)
@@ -47,23 +76,147 @@ void  kos_deallocate(kos_allocator_function allocator, void* memory)
     allocator(KOS_ALLOC_DEALLOCATE, memory, 0);
 }
 
+static usize arena_grown_block_size(usize blockSize)
+{
+    if (blockSize >= KOS_ARENA_MAX_GROWN_BLOCK_SIZE)
+        return blockSize;
+
+    usize grownBlockSize = blockSize * 2;
+    return grownBlockSize > KOS_ARENA_MAX_GROWN_BLOCK_SIZE ? KOS_ARENA_MAX_GROWN_BLOCK_SIZE : grownBlockSize;
+}
+
+static void arena_track_commit(kos_arena_allocator* arena, usize count)
+{
+    arena->committedBytes += count;
+    if (arena->committedBytes > arena->peakCommittedBytes)
+        arena->peakCommittedBytes = arena->committedBytes;
+}
+
+static void arena_release_block(kos_arena_allocator* arena, kos_arena_block block)
+{
+    kos_deallocate(arena->baseAllocator, block.data);
+    arena->committedBytes -= block.blockSize;
+}
+
 static void arena_add_block(kos_arena_allocator* arena)
 {
-    arena->blockCount++;
-    kos_arena_block* newBlockMemory = kos_reallocate(arena->baseAllocator, arena->blocks, sizeof(kos_arena_block) * arena->blockCount);
-    memcpy(newBlockMemory, arena->blocks, arena->blockCount - 1);
+    if (arena->blockCount == arena->blockCapacity)
+    {
+        arena->blockCapacity = arena->blockCapacity == 0 ? 8 : arena->blockCapacity * 2;
+        arena->blocks = kos_reallocate(arena->baseAllocator, arena->blocks, sizeof(kos_arena_block) * arena->blockCapacity);
+        assert(arena->blocks != nullptr);
+    }
 
     kos_arena_block newBlock = {
-        .data = kos_allocate(arena->baseAllocator, arena->blockSize),
-        .blockSize = arena->blockSize,
+        .data = kos_allocate(arena->baseAllocator, arena->nextBlockSize),
+        .blockSize = arena->nextBlockSize,
         .allocated = 0,
     };
-    newBlockMemory[arena->blockCount - 1] = newBlock;
+    assert(newBlock.data != nullptr);
+    arena->blocks[arena->blockCount] = newBlock;
+    arena->blockCount++;
+    arena_track_commit(arena, newBlock.blockSize);
+
+    arena->nextBlockSize = arena_grown_block_size(arena->nextBlockSize);
+}
 
-    arena->blocks = newBlockMemory;
+// the base allocator is only relied on for KOS_ARENA_DEFAULT_ALIGNMENT, stricter alignments are padded for.
+static usize arena_alignment_padding(usize alignment)
+{
+    return alignment > KOS_ARENA_DEFAULT_ALIGNMENT ? alignment - 1 : 0;
+}
+
+static void* arena_align_pointer(void* pointer, usize alignment)
+{
+    uintptr_t address = cast(uintptr_t) pointer;
+    return cast(void*) ((address + alignment - 1) & ~cast(uintptr_t) (alignment - 1));
 }
 
-kos_arena_block* arena_current_block(kos_arena_allocator* arena)
+static void* arena_push_large_block(kos_arena_allocator* arena, usize count, usize alignment)
+{
+    if (arena->largeBlockCount == arena->largeBlockCapacity)
+    {
+        arena->largeBlockCapacity = arena->largeBlockCapacity == 0 ? 8 : arena->largeBlockCapacity * 2;
+        arena->largeBlocks = kos_reallocate(arena->baseAllocator, arena->largeBlocks, sizeof(kos_arena_block) * arena->largeBlockCapacity);
+        assert(arena->largeBlocks != nullptr);
+    }
+
+    usize blockSize = count + arena_alignment_padding(alignment);
+    kos_arena_block newBlock = {
+        .data = kos_allocate(arena->baseAllocator, blockSize),
+        .blockSize = blockSize,
+        .allocated = blockSize,
+    };
+    assert(newBlock.data != nullptr);
+    arena->largeBlocks[arena->largeBlockCount] = newBlock;
+    arena->largeBlockCount++;
+    arena_track_commit(arena, blockSize);
+
+    return arena_align_pointer(newBlock.data, alignment);
+}
+
+static void* arena_virtual_reserve(usize reserveSize)
+{
+#ifndef _WIN32
+    void* memory = mmap(nullptr, reserveSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return memory == MAP_FAILED ? nullptr : memory;
+#else
+    return VirtualAlloc(nullptr, reserveSize, MEM_RESERVE, PAGE_NOACCESS);
+#endif
+}
+
+static void arena_virtual_release(void* memory, usize reserveSize)
+{
+#ifndef _WIN32
+    munmap(memory, reserveSize);
+#else
+    VirtualFree(memory, 0, MEM_RELEASE);
+#endif
+}
+
+static bool arena_virtual_commit(kos_arena_allocator* arena, usize size)
+{
+    kos_arena_block* block = &arena->blocks[0];
+
+    usize newCommittedSize = (size + KOS_ARENA_VIRTUAL_COMMIT_SIZE - 1) / KOS_ARENA_VIRTUAL_COMMIT_SIZE * KOS_ARENA_VIRTUAL_COMMIT_SIZE;
+    if (newCommittedSize > block->blockSize)
+        newCommittedSize = block->blockSize;
+
+    char* commitStart = cast(char*) block->data + arena->committedSize;
+    usize commitSize = newCommittedSize - arena->committedSize;
+
+#ifndef _WIN32
+    if (0 != mprotect(commitStart, commitSize, PROT_READ | PROT_WRITE))
+        return false;
+#else
+    if (nullptr == VirtualAlloc(commitStart, commitSize, MEM_COMMIT, PAGE_READWRITE))
+        return false;
+#endif
+
+    arena->committedSize = newCommittedSize;
+    arena_track_commit(arena, commitSize);
+    return true;
+}
+
+// gives the committed pages back to the OS, the address range stays reserved.
+static void arena_virtual_decommit(kos_arena_allocator* arena)
+{
+    if (arena->committedSize == 0)
+        return;
+
+#ifndef _WIN32
+    // the pages are dropped and made inaccessible again, they read as zero once they're committed again.
+    madvise(arena->blocks[0].data, arena->committedSize, MADV_DONTNEED);
+    mprotect(arena->blocks[0].data, arena->committedSize, PROT_NONE);
+#else
+    VirtualFree(arena->blocks[0].data, arena->committedSize, MEM_DECOMMIT);
+#endif
+
+    arena->committedBytes -= arena->committedSize;
+    arena->committedSize = 0;
+}
+
+static kos_arena_block* arena_current_block(kos_arena_allocator* arena)
 {
     return arena->blocks + (arena->blockCount - 1);
 }
@@ -72,22 +225,67 @@ kos_arena_allocator* kos_arena_create(kos_allocator_function baseAllocator, usiz
 {
     if (baseAllocator == nullptr)
         baseAllocator = default_allocator;
+
+    assert(blockSize > 0);
     
     kos_arena_allocator* arena = kos_allocate(baseAllocator, sizeof(kos_arena_allocator));
-    arena->baseAllocator = baseAllocator;
-    arena->blocks = nullptr;
-    arena->blockSize = blockSize;
-    arena->blockCount = 0;
+    *arena = (kos_arena_allocator){
+        .baseAllocator = baseAllocator,
+        .blockSize = blockSize,
+        .nextBlockSize = blockSize,
+    };
 
     arena_add_block(arena);
     return arena;
 }
 
+kos_arena_allocator* kos_arena_create_virtual(kos_allocator_function baseAllocator, usize reserveSize)
+{
+    if (baseAllocator == nullptr)
+        baseAllocator = default_allocator;
+
+    reserveSize = (reserveSize + KOS_ARENA_VIRTUAL_COMMIT_SIZE - 1) / KOS_ARENA_VIRTUAL_COMMIT_SIZE * KOS_ARENA_VIRTUAL_COMMIT_SIZE;
+    assert(reserveSize > 0);
+
+    void* reservedMemory = arena_virtual_reserve(reserveSize);
+    if (reservedMemory == nullptr)
+        return kos_arena_create(baseAllocator, KOS_ARENA_VIRTUAL_COMMIT_SIZE);
+
+    kos_arena_allocator* arena = kos_allocate(baseAllocator, sizeof(kos_arena_allocator));
+    *arena = (kos_arena_allocator){
+        .baseAllocator = baseAllocator,
+        .blocks = kos_allocate(baseAllocator, sizeof(kos_arena_block)),
+        .blockCount = 1,
+        .blockCapacity = 1,
+        .blockSize = reserveSize,
+        .nextBlockSize = reserveSize,
+        .isVirtual = true,
+    };
+
+    assert(arena->blocks != nullptr);
+    arena->blocks[0] = (kos_arena_block){
+        .data = reservedMemory,
+        .blockSize = reserveSize,
+        .allocated = 0,
+    };
+
+    return arena;
+}
+
 void kos_arena_destroy(kos_arena_allocator* arena)
 {
-    for (usize i = 0; i < arena->blockCount; i++)
-        kos_deallocate(arena->baseAllocator, arena->blocks[i].data);
+    if (arena->isVirtual)
+        arena_virtual_release(arena->blocks[0].data, arena->blocks[0].blockSize);
+    else
+    {
+        for (usize i = 0; i < arena->blockCount; i++)
+            kos_deallocate(arena->baseAllocator, arena->blocks[i].data);
+    }
+
+    for (usize i = 0; i < arena->largeBlockCount; i++)
+        kos_deallocate(arena->baseAllocator, arena->largeBlocks[i].data);
     kos_deallocate(arena->baseAllocator, arena->blocks);
+    kos_deallocate(arena->baseAllocator, arena->largeBlocks);
     kos_deallocate(arena->baseAllocator, arena);
 }
 
@@ -96,33 +294,147 @@ void kos_arena_clear(kos_arena_allocator* arena)
     assert(arena->blockCount > 0);
 
     for (usize i = 1; i < arena->blockCount; i++)
-        kos_deallocate(arena->baseAllocator, arena->blocks[i].data);
-    
-    memset(arena->blocks[0].data, 0, arena->blockSize);
+        arena_release_block(arena, arena->blocks[i]);
+    for (usize i = 0; i < arena->largeBlockCount; i++)
+        arena_release_block(arena, arena->largeBlocks[i]);
+
+    // the first block is kept, pushes zero their memory so it doesn't have to be cleared here.
+    if (arena->isVirtual)
+        arena_virtual_decommit(arena);
+
+    arena->blocks[0].allocated = 0;
     arena->blockCount = 1;
+    arena->largeBlockCount = 0;
+    arena->nextBlockSize = arena_grown_block_size(arena->blocks[0].blockSize);
 }
 
-void* kos_arena_push(kos_arena_allocator* arena, usize count)
+kos_arena_marker kos_arena_mark(kos_arena_allocator* arena)
+{
+    assert(arena != nullptr);
+    return (kos_arena_marker){
+        .blockCount = arena->blockCount,
+        .allocated = arena_current_block(arena)->allocated,
+        .largeBlockCount = arena->largeBlockCount,
+    };
+}
+
+void kos_arena_rewind(kos_arena_allocator* arena, kos_arena_marker marker)
+{
+    assert(arena != nullptr);
+    assert(marker.blockCount > 0 && marker.blockCount <= arena->blockCount, "arena marker is not from this arena, or the arena was rewound past it");
+    assert(marker.largeBlockCount <= arena->largeBlockCount, "arena marker is not from this arena, or the arena was rewound past it");
+
+    for (usize i = marker.blockCount; i < arena->blockCount; i++)
+        arena_release_block(arena, arena->blocks[i]);
+    for (usize i = marker.largeBlockCount; i < arena->largeBlockCount; i++)
+        arena_release_block(arena, arena->largeBlocks[i]);
+
+    arena->blockCount = marker.blockCount;
+    arena->largeBlockCount = marker.largeBlockCount;
+
+    kos_arena_block* currentBlock = arena_current_block(arena);
+    assert(marker.allocated <= currentBlock->allocated, "arena marker is not from this arena, or the arena was rewound past it");
+    currentBlock->allocated = marker.allocated;
+
+    arena->nextBlockSize = arena_grown_block_size(currentBlock->blockSize);
+}
+
+static void* arena_push_virtual(kos_arena_allocator* arena, usize count, usize alignment)
+{
+    kos_arena_block* block = &arena->blocks[0];
+
+    char* blockData = block->data;
+    char* data = arena_align_pointer(blockData + block->allocated, alignment);
+    usize newAllocated = cast(usize) (data - blockData) + count;
+
+    // once the reserved range is used up, or can't be committed, the arena carries on with dedicated blocks.
+    if (newAllocated > block->blockSize)
+        return arena_push_large_block(arena, count, alignment);
+
+    if (newAllocated > arena->committedSize && !arena_virtual_commit(arena, newAllocated))
+        return arena_push_large_block(arena, count, alignment);
+
+    block->allocated = newAllocated;
+    return data;
+}
+
+void* kos_arena_push_uninit(kos_arena_allocator* arena, usize count, usize alignment)
 {
     assert(arena != nullptr && "kos_arena_push got nullptr arena");
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0, "arena alignment must be a power of two");
 
-    if (count > arena->blockSize)
-    {
-        KOS_INTERNAL_PROGRAM_ERROR("attempt to allocate %zu bytes in an arena with a block size of %zu.", count, arena->blockSize);
-        return nullptr;
-    }
+    arena->pushCount++;
+    arena->requestedBytes += count;
+
+    if (arena->isVirtual)
+        return arena_push_virtual(arena, count, alignment);
+
+    if (count + arena_alignment_padding(alignment) > arena->blockSize)
+        return arena_push_large_block(arena, count, alignment);
 
     kos_arena_block* currentBlock = arena_current_block(arena);
     assert(currentBlock != nullptr);
-    if (count > currentBlock->blockSize - currentBlock->allocated)
+
+    char* blockData = currentBlock->data;
+    char* data = arena_align_pointer(blockData + currentBlock->allocated, alignment);
+    if (cast(usize) (data - blockData) + count > currentBlock->blockSize)
     {
+        arena->wastedBytes += currentBlock->blockSize - currentBlock->allocated;
         arena_add_block(arena);
         currentBlock = arena_current_block(arena);
+
+        blockData = currentBlock->data;
+        data = arena_align_pointer(blockData, alignment);
     }
 
-    void* data = cast(char*) currentBlock->data + currentBlock->allocated;
-    currentBlock->allocated += count;
+    currentBlock->allocated = cast(usize) (data - blockData) + count;
+    return data;
+}
 
+void* kos_arena_push_aligned(kos_arena_allocator* arena, usize count, usize alignment)
+{
+    void* data = kos_arena_push_uninit(arena, count, alignment);
     memset(data, 0, count);
     return data;
 }
+
+void* kos_arena_push(kos_arena_allocator* arena, usize count)
+{
+    return kos_arena_push_aligned(arena, count, KOS_ARENA_DEFAULT_ALIGNMENT);
+}
+
+kos_arena_stats kos_arena_get_stats(kos_arena_allocator* arena)
+{
+    assert(arena != nullptr);
+
+    kos_arena_stats stats = {
+        .pushCount = arena->pushCount,
+        .requestedBytes = arena->requestedBytes,
+        .committedBytes = arena->committedBytes,
+        .peakCommittedBytes = arena->peakCommittedBytes,
+        .wastedBytes = arena->wastedBytes,
+        .blockCount = arena->blockCount,
+        .largeBlockCount = arena->largeBlockCount,
+    };
+
+    for (usize i = 0; i < arena->blockCount; i++)
+        stats.usedBytes += arena->blocks[i].allocated;
+    for (usize i = 0; i < arena->largeBlockCount; i++)
+        stats.usedBytes += arena->largeBlocks[i].allocated;
+
+    return stats;
+}
+
+void kos_arena_stats_add(kos_arena_stats* total, kos_arena_stats stats)
+{
+    assert(total != nullptr);
+
+    total->pushCount += stats.pushCount;
+    total->requestedBytes += stats.requestedBytes;
+    total->usedBytes += stats.usedBytes;
+    total->committedBytes += stats.committedBytes;
+    total->peakCommittedBytes += stats.peakCommittedBytes;
+    total->wastedBytes += stats.wastedBytes;
+    total->blockCount += stats.blockCount;
+    total->largeBlockCount += stats.largeBlockCount;
+}
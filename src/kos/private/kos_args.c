@@ -1,9 +1,24 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "kos/args.h"
 #include "kos/stb_ds.h"
 
+// hands a parsed argument to the parser function, exiting like any other bad argument if it's rejected.
+static void kos_args_call_parser(kos_args_parser_function parserFunction, kos_arg_parsed parsedArg, kos_args_state* state)
+{
+    if (parserFunction(parsedArg, state) == KOS_ARGS_PARSED_OK)
+        return;
+
+    if (parsedArg.kind == KOS_ARG_LONG)
+        fprintf(stderr, "The provided option `--" KOS_STRING_VIEW_FORMAT "` does not accept the value `" KOS_STRING_VIEW_FORMAT "`.\n", KOS_STRING_VIEW_EXPAND(parsedArg.longOption), KOS_STRING_VIEW_EXPAND(parsedArg.value));
+    else if (parsedArg.kind == KOS_ARG_SHORT)
+        fprintf(stderr, "The provided option `-%c` does not accept the value `" KOS_STRING_VIEW_FORMAT "`.\n", parsedArg.shortOption, KOS_STRING_VIEW_EXPAND(parsedArg.value));
+    else fprintf(stderr, "The provided argument `" KOS_STRING_VIEW_FORMAT "` is invalid.\n", KOS_STRING_VIEW_EXPAND(parsedArg.value));
+    exit(1);
+}
+
 void kos_args_parse(kos_args_parser* parser, int argc, char** argv, void* input)
 {
     kos_args_state state = {
@@ -26,7 +41,7 @@ void kos_args_parse(kos_args_parser* parser, int argc, char** argv, void* input)
             if (argLength == 1)
             {
                 kos_arg_parsed parsedArg = { .kind = KOS_ARG_VALUE, .value = argView };
-                parserFunction(parsedArg, &state);
+                kos_args_call_parser(parserFunction, parsedArg, &state);
                 continue;
             }
 
@@ -42,7 +57,7 @@ void kos_args_parse(kos_args_parser* parser, int argc, char** argv, void* input)
                     else
                     {
                         kos_arg_parsed parsedArg = { .kind = KOS_ARG_VALUE, .value = argView };
-                        parserFunction(parsedArg, &state);
+                        kos_args_call_parser(parserFunction, parsedArg, &state);
                         continue;
                     }
                 }
@@ -79,7 +94,7 @@ void kos_args_parse(kos_args_parser* parser, int argc, char** argv, void* input)
                             };
                         }
 
-                        parserFunction(parsedArg, &state);
+                        kos_args_call_parser(parserFunction, parsedArg, &state);
                         goto continue_arg_loop;
                     }
                 }
@@ -120,7 +135,7 @@ void kos_args_parse(kos_args_parser* parser, int argc, char** argv, void* input)
                         };
                     }
 
-                    parserFunction(parsedArg, &state);
+                    kos_args_call_parser(parserFunction, parsedArg, &state);
                     goto continue_arg_loop;
                 }
             }
@@ -132,7 +147,7 @@ void kos_args_parse(kos_args_parser* parser, int argc, char** argv, void* input)
         else
         {
             kos_arg_parsed parsedArg = { .kind = KOS_ARG_VALUE, .value = argView };
-            parserFunction(parsedArg, &state);
+            kos_args_call_parser(parserFunction, parsedArg, &state);
         }
 
     continue_arg_loop:;
@@ -1,5 +1,11 @@
 #ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
 #include <limits.h> /* PATH_MAX */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 #else
 # define WIN32_LEAN_AND_MEAN
 # include "Windows.h"
@@ -7,6 +13,8 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "kos/allocator.h"
 #include "kos/builtins.h"
@@ -14,7 +22,54 @@
 #include "kos/platform.h"
 #include "kos/string.h"
 
-// TODO(local): kos_platform_read_file is actually just libc calls right now
+// marks a file string as a memory mapping, it's never actually called.
+static void* platform_mapped_file_allocator(kos_allocator_action action, void* memory, usize count)
+{
+    KOS_INTERNAL_PROGRAM_ERROR("memory mapped files must be released with kos_platform_free_file");
+    return nullptr;
+}
+
+#ifndef _WIN32
+// the mapping always covers at least one byte past the end of the file, so there is room for the 0 sentinel.
+static usize platform_mapped_file_size(usize fileLength)
+{
+    usize pageSize = cast(usize) sysconf(_SC_PAGESIZE);
+    return (fileLength + 1 + pageSize - 1) / pageSize * pageSize;
+}
+
+static bool platform_map_file(int fileDescriptor, usize fileLength, kos_string* result)
+{
+    usize mappedSize = platform_mapped_file_size(fileLength);
+
+    // reserve zeroed pages for the whole range first, then map the file over the front of it.
+    // the bytes after the file are then 0 even when its length is an exact multiple of the page size.
+    uchar* memory = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return false;
+
+    if (fileLength > 0)
+    {
+        void* fileMemory = mmap(memory, fileLength, PROT_READ, MAP_PRIVATE | MAP_FIXED, fileDescriptor, 0);
+        if (fileMemory == MAP_FAILED)
+        {
+            munmap(memory, mappedSize);
+            return false;
+        }
+
+        madvise(memory, fileLength, MADV_SEQUENTIAL);
+    }
+
+    *result = (kos_string){
+        .allocator = platform_mapped_file_allocator,
+        .memory = memory,
+        .count = fileLength,
+        .isNulTerminated = true,
+    };
+
+    return true;
+}
+#endif
+
 kos_string kos_platform_read_file(const char* path, kos_allocator_function allocator, kos_platform_read_file_status* status)
 {
     if (path == nullptr)
@@ -23,10 +78,40 @@ kos_string kos_platform_read_file(const char* path, kos_allocator_function alloc
         return KOS_STRING_EMPTY;
     }
 
+#ifndef _WIN32
+    // without an allocator to read into, the file is mapped straight from the page cache.
+    if (allocator == nullptr)
+    {
+        int fileDescriptor = open(path, O_RDONLY);
+        if (fileDescriptor < 0)
+        {
+            if (status) *status = errno == ENOENT ? KOS_PLATFORM_READ_FILE_DOES_NOT_EXIST : KOS_PLATFORM_READ_FILE_FAILED;
+            return KOS_STRING_EMPTY;
+        }
+
+        struct stat fileStat;
+        if (fstat(fileDescriptor, &fileStat) == 0 && S_ISREG(fileStat.st_mode))
+        {
+            kos_string result;
+            bool isMapped = platform_map_file(fileDescriptor, cast(usize) fileStat.st_size, &result);
+            close(fileDescriptor);
+
+            if (isMapped)
+            {
+                if (status) *status = KOS_PLATFORM_READ_FILE_SUCCESS;
+                return result;
+            }
+        }
+        else close(fileDescriptor);
+        
+        // fall back to reading the file, for example when it's a pipe.
+    }
+#endif
+
     if (allocator == nullptr)
         allocator = kos_default_allocator;
 
-    FILE* fileHandle = fopen(cast(const char*) path, "r");
+    FILE* fileHandle = fopen(cast(const char*) path, "rb");
     if (fileHandle == nullptr)
     {
         if (status) *status = KOS_PLATFORM_READ_FILE_FAILED;
@@ -37,18 +122,77 @@ kos_string kos_platform_read_file(const char* path, kos_allocator_function alloc
     usize fileLength = cast(usize) ftell(fileHandle);
     fseek(fileHandle, 0, SEEK_SET);
 
-    uchar* sourceText = kos_allocate(allocator, fileLength);
-    fread(sourceText, sizeof(uchar), fileLength, fileHandle);
+    uchar* sourceText = kos_allocate(allocator, fileLength + 1);
+    fileLength = fread(sourceText, sizeof(uchar), fileLength, fileHandle);
+    sourceText[fileLength] = 0;
 
     fclose(fileHandle);
 
     if (status) *status = KOS_PLATFORM_READ_FILE_SUCCESS;
-    return kos_string_create(allocator, sourceText, fileLength);
+
+    kos_string result = kos_string_create(allocator, sourceText, fileLength);
+    result.isNulTerminated = true;
+    return result;
+}
+
+void kos_platform_free_file(kos_string file)
+{
+    if (file.memory == nullptr)
+        return;
+
+    if (file.allocator == platform_mapped_file_allocator)
+    {
+#ifndef _WIN32
+        munmap(cast(void*) file.memory, platform_mapped_file_size(file.count));
+#endif
+        return;
+    }
+
+    kos_string_deallocate(file);
+}
+
+bool kos_platform_get_file_identity(const char* path, kos_platform_file_identity* identity)
+{
+    assert(path != nullptr);
+    assert(identity != nullptr);
+
+#ifndef _WIN32
+    struct stat fileStat;
+    if (stat(path, &fileStat) != 0)
+        return false;
+
+    *identity = (kos_platform_file_identity){
+        .device = cast(u64) fileStat.st_dev,
+        .inode = cast(u64) fileStat.st_ino,
+    };
+
+    return true;
+#else
+    HANDLE fileHandle = CreateFileA(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    BY_HANDLE_FILE_INFORMATION fileInfo;
+    BOOL hasInfo = GetFileInformationByHandle(fileHandle, &fileInfo);
+    CloseHandle(fileHandle);
+
+    if (!hasInfo)
+        return false;
+
+    *identity = (kos_platform_file_identity){
+        .device = cast(u64) fileInfo.dwVolumeSerialNumber,
+        .inode = (cast(u64) fileInfo.nFileIndexHigh << 32) | cast(u64) fileInfo.nFileIndexLow,
+    };
+
+    return true;
+#endif
 }
 
 kos_string kos_platform_full_path(kos_string_view path)
 {
-    TCHAR nameBuffer[1024] = { 0 };
+    char nameBuffer[1024] = { 0 };
+    assert(path.count < sizeof nameBuffer);
     memcpy(nameBuffer, path.memory, path.count);
     
     usize outBufferCount = 1024;
@@ -124,3 +268,24 @@ kos_string kos_platform_path_combine(kos_string_view path0, kos_string_view path
 
     return result;
 }
+
+u64 kos_platform_monotonic_nanoseconds(void)
+{
+#ifndef _WIN32
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return cast(u64) now.tv_sec * 1000000000ull + cast(u64) now.tv_nsec;
+#else
+    static LARGE_INTEGER frequency = { 0 };
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    // split to avoid overflowing the multiplication on long uptimes.
+    u64 ticks = cast(u64) now.QuadPart;
+    u64 ticksPerSecond = cast(u64) frequency.QuadPart;
+    return (ticks / ticksPerSecond) * 1000000000ull + (ticks % ticksPerSecond) * 1000000000ull / ticksPerSecond;
+#endif
+}
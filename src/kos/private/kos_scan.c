@@ -0,0 +1,301 @@
+#include "kos/builtins.h"
+#include "kos/scan.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define KOS_SCAN_HAS_X86_KERNELS 1
+#  include <emmintrin.h>
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define KOS_SCAN_TARGET_AVX2
+#  else
+#    define KOS_SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+#endif
+
+typedef struct kos_scan_kernel_functions
+{
+    usize (*skipWhitespace)(const uchar* data, usize position, usize count);
+    usize (*findNewline)(const uchar* data, usize position, usize count);
+    usize (*findBlockCommentEnd)(const uchar* data, usize position, usize count);
+} kos_scan_kernel_functions;
+
+static bool scan_is_space(uchar c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static usize scalar_skip_whitespace(const uchar* data, usize position, usize count)
+{
+    while (position < count && scan_is_space(data[position]))
+        position++;
+    return position;
+}
+
+static usize scalar_find_newline(const uchar* data, usize position, usize count)
+{
+    while (position < count && data[position] != '\n')
+        position++;
+    return position;
+}
+
+static usize scalar_find_block_comment_end(const uchar* data, usize position, usize count)
+{
+    for (; position + 1 < count; position++)
+    {
+        if (data[position] == '*' && data[position + 1] == '/')
+            return position;
+    }
+
+    return count;
+}
+
+static const kos_scan_kernel_functions scalarKernel = {
+    scalar_skip_whitespace,
+    scalar_find_newline,
+    scalar_find_block_comment_end,
+};
+
+#ifdef KOS_SCAN_HAS_X86_KERNELS
+
+static u32 scan_first_set_bit(u32 mask)
+{
+    assert(mask != 0);
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return cast(u32) index;
+#else
+    return cast(u32) __builtin_ctz(mask);
+#endif
+}
+
+// the SIMD kernels only ever load whole vectors which lie entirely within `count` and
+// hand the remaining tail bytes to the scalar kernel.
+
+static usize sse2_skip_whitespace(const uchar* data, usize position, usize count)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    for (; position + 16 <= count; position += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(cast(const __m128i*) (data + position));
+        __m128i isSpace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+
+        u32 notSpaceMask = ~cast(u32) _mm_movemask_epi8(isSpace) & 0xFFFF;
+        if (notSpaceMask != 0)
+            return position + scan_first_set_bit(notSpaceMask);
+    }
+
+    return scalar_skip_whitespace(data, position, count);
+}
+
+static usize sse2_find_newline(const uchar* data, usize position, usize count)
+{
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    for (; position + 16 <= count; position += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(cast(const __m128i*) (data + position));
+        u32 newlineMask = cast(u32) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, lf));
+        if (newlineMask != 0)
+            return position + scan_first_set_bit(newlineMask);
+    }
+
+    return scalar_find_newline(data, position, count);
+}
+
+static usize sse2_find_block_comment_end(const uchar* data, usize position, usize count)
+{
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+
+    // compare each byte as a possible '*' against the byte after it as a possible '/'.
+    for (; position + 17 <= count; position += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(cast(const __m128i*) (data + position));
+        __m128i nextChunk = _mm_loadu_si128(cast(const __m128i*) (data + position + 1));
+        __m128i isEnd = _mm_and_si128(_mm_cmpeq_epi8(chunk, star), _mm_cmpeq_epi8(nextChunk, slash));
+
+        u32 endMask = cast(u32) _mm_movemask_epi8(isEnd);
+        if (endMask != 0)
+            return position + scan_first_set_bit(endMask);
+    }
+
+    return scalar_find_block_comment_end(data, position, count);
+}
+
+static const kos_scan_kernel_functions sse2Kernel = {
+    sse2_skip_whitespace,
+    sse2_find_newline,
+    sse2_find_block_comment_end,
+};
+
+KOS_SCAN_TARGET_AVX2
+static usize avx2_skip_whitespace(const uchar* data, usize position, usize count)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    for (; position + 32 <= count; position += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(cast(const __m256i*) (data + position));
+        __m256i isSpace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, cr), _mm256_cmpeq_epi8(chunk, lf)));
+
+        u32 notSpaceMask = ~cast(u32) _mm256_movemask_epi8(isSpace);
+        if (notSpaceMask != 0)
+            return position + scan_first_set_bit(notSpaceMask);
+    }
+
+    return sse2_skip_whitespace(data, position, count);
+}
+
+KOS_SCAN_TARGET_AVX2
+static usize avx2_find_newline(const uchar* data, usize position, usize count)
+{
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    for (; position + 32 <= count; position += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(cast(const __m256i*) (data + position));
+        u32 newlineMask = cast(u32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, lf));
+        if (newlineMask != 0)
+            return position + scan_first_set_bit(newlineMask);
+    }
+
+    return sse2_find_newline(data, position, count);
+}
+
+KOS_SCAN_TARGET_AVX2
+static usize avx2_find_block_comment_end(const uchar* data, usize position, usize count)
+{
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+
+    for (; position + 33 <= count; position += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(cast(const __m256i*) (data + position));
+        __m256i nextChunk = _mm256_loadu_si256(cast(const __m256i*) (data + position + 1));
+        __m256i isEnd = _mm256_and_si256(_mm256_cmpeq_epi8(chunk, star), _mm256_cmpeq_epi8(nextChunk, slash));
+
+        u32 endMask = cast(u32) _mm256_movemask_epi8(isEnd);
+        if (endMask != 0)
+            return position + scan_first_set_bit(endMask);
+    }
+
+    return sse2_find_block_comment_end(data, position, count);
+}
+
+static const kos_scan_kernel_functions avx2Kernel = {
+    avx2_skip_whitespace,
+    avx2_find_newline,
+    avx2_find_block_comment_end,
+};
+
+static bool scan_cpu_supports_avx2(void)
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // AVX2 also needs the OS to save the upper halves of the ymm registers.
+    __cpuid(info, 1);
+    bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+    bool hasAvx = (info[2] & (1 << 28)) != 0;
+    if (!hasOsxsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // KOS_SCAN_HAS_X86_KERNELS
+
+static const kos_scan_kernel_functions* currentKernelFunctions = nullptr;
+static kos_scan_kernel currentKernel = KOS_SCAN_KERNEL_SCALAR;
+
+bool kos_scan_select_kernel(kos_scan_kernel kernel)
+{
+    switch (kernel)
+    {
+        case KOS_SCAN_KERNEL_AUTO:
+        {
+#ifdef KOS_SCAN_HAS_X86_KERNELS
+            if (scan_cpu_supports_avx2())
+                return kos_scan_select_kernel(KOS_SCAN_KERNEL_AVX2);
+            return kos_scan_select_kernel(KOS_SCAN_KERNEL_SSE2);
+#else
+            return kos_scan_select_kernel(KOS_SCAN_KERNEL_SCALAR);
+#endif
+        }
+
+        case KOS_SCAN_KERNEL_SCALAR:
+        {
+            currentKernelFunctions = &scalarKernel;
+        } break;
+
+#ifdef KOS_SCAN_HAS_X86_KERNELS
+        // SSE2 is part of the x86-64 baseline, so it never needs a runtime check.
+        case KOS_SCAN_KERNEL_SSE2:
+        {
+            currentKernelFunctions = &sse2Kernel;
+        } break;
+
+        case KOS_SCAN_KERNEL_AVX2:
+        {
+            if (!scan_cpu_supports_avx2())
+                return false;
+            currentKernelFunctions = &avx2Kernel;
+        } break;
+#endif
+
+        default: return false;
+    }
+
+    currentKernel = kernel;
+    return true;
+}
+
+static const kos_scan_kernel_functions* scan_kernel_functions(void)
+{
+    if (currentKernelFunctions == nullptr)
+        kos_scan_select_kernel(KOS_SCAN_KERNEL_AUTO);
+    assert(currentKernelFunctions != nullptr);
+    return currentKernelFunctions;
+}
+
+kos_scan_kernel kos_scan_current_kernel(void)
+{
+    scan_kernel_functions();
+    return currentKernel;
+}
+
+usize kos_scan_skip_whitespace(const uchar* data, usize position, usize count)
+{
+    return scan_kernel_functions()->skipWhitespace(data, position, count);
+}
+
+usize kos_scan_find_newline(const uchar* data, usize position, usize count)
+{
+    return scan_kernel_functions()->findNewline(data, position, count);
+}
+
+usize kos_scan_find_block_comment_end(const uchar* data, usize position, usize count)
+{
+    return scan_kernel_functions()->findBlockCommentEnd(data, position, count);
+}
@@ -1,2 +1,58 @@
+#include <string.h>
+
+#include "kos/allocator.h"
+#include "kos/builtins.h"
+#include "kos/list.h"
+
 #define STB_DS_IMPLEMENTATION
 #include "kos/stb_ds.h"
+
+// stored in front of every block stb_ds allocates, it's as large as the arena's default alignment
+// so the stb_ds header and the elements after it stay aligned.
+typedef struct kos_stb_ds_prefix
+{
+    // the arena the block lives in, or nullptr if it's from the default allocator.
+    kos_arena_allocator* arena;
+    usize count;
+} kos_stb_ds_prefix;
+
+void* kos_stb_ds_realloc(void* memory, usize count)
+{
+    kos_stb_ds_prefix* prefix = memory == nullptr ? nullptr : cast(kos_stb_ds_prefix*) memory - 1;
+    if (prefix == nullptr || prefix->arena == nullptr)
+    {
+        prefix = kos_reallocate(kos_default_allocator, prefix, sizeof(kos_stb_ds_prefix) + count);
+        assert(prefix != nullptr);
+        *prefix = (kos_stb_ds_prefix){ .arena = nullptr, .count = count };
+        return prefix + 1;
+    }
+
+    // arena memory can't be resized, so the block moves to the end of the arena and the old one is left behind.
+    kos_stb_ds_prefix* newPrefix = kos_arena_push_uninit(prefix->arena, sizeof(kos_stb_ds_prefix) + count, KOS_ARENA_DEFAULT_ALIGNMENT);
+    *newPrefix = (kos_stb_ds_prefix){ .arena = prefix->arena, .count = count };
+    memcpy(newPrefix + 1, prefix + 1, prefix->count < count ? prefix->count : count);
+    return newPrefix + 1;
+}
+
+void kos_stb_ds_free(void* memory)
+{
+    if (memory == nullptr)
+        return;
+
+    kos_stb_ds_prefix* prefix = cast(kos_stb_ds_prefix*) memory - 1;
+    if (prefix->arena == nullptr)
+        kos_deallocate(kos_default_allocator, prefix);
+}
+
+void* kos_arena_list_create(kos_arena_allocator* arena, usize elementSize, usize capacity)
+{
+    assert(arena != nullptr);
+
+    usize count = sizeof(stbds_array_header) + elementSize * capacity;
+    kos_stb_ds_prefix* prefix = kos_arena_push_uninit(arena, sizeof(kos_stb_ds_prefix) + count, KOS_ARENA_DEFAULT_ALIGNMENT);
+    *prefix = (kos_stb_ds_prefix){ .arena = arena, .count = count };
+
+    stbds_array_header* header = cast(stbds_array_header*) (prefix + 1);
+    *header = (stbds_array_header){ .length = 0, .capacity = capacity };
+    return header + 1;
+}
@@ -1,3 +1,5 @@
+#include <stdarg.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "kos/builtins.h"
@@ -152,6 +154,18 @@ bool kos_string_view_ends_with_constant(kos_string_view sv, const char* constant
     return 0 == memcmp(sv.memory + (sv.count - constantLength), constant, constantLength);
 }
 
+u64 kos_string_view_hash(kos_string_view sv)
+{
+    u64 hash = 14695981039346656037ull;
+    for (usize i = 0; i < sv.count; i++)
+    {
+        hash ^= sv.memory[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
 static void kos_string_builder_ensure_capacity(kos_string_builder* sb, usize minCapacity)
 {
     assert(sb->allocator != nullptr);
@@ -230,7 +244,8 @@ kos_string kos_string_builder_to_string_arena(kos_string_builder* sb, kos_arena_
     result.allocator = nullptr;
     result.count = sb->count;
 
-    uchar* memory = kos_arena_push(arena, result.count + 1);
+    // every byte is written below, and strings need no alignment.
+    uchar* memory = kos_arena_push_uninit(arena, result.count + 1, 1);
     memory[result.count] = 0; // doesn't hurt to nul terminate anyway
     memcpy(memory, sb->memory, result.count);
     
@@ -322,6 +337,53 @@ void kos_string_builder_append_cstring(kos_string_builder* sb, const char* s)
     sb->count += sLen;
 }
 
+void kos_string_builder_append_repeat(kos_string_builder* sb, uchar value, usize count)
+{
+    assert(sb != nullptr);
+    if (count == 0)
+        return;
+
+    kos_string_builder_ensure_capacity(sb, sb->count + count);
+
+    memset(sb->memory + sb->count, value, count);
+    sb->count += count;
+}
+
+void kos_string_builder_append_format(kos_string_builder* sb, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    kos_string_builder_append_vformat(sb, fmt, ap);
+    va_end(ap);
+}
+
+void kos_string_builder_append_vformat(kos_string_builder* sb, const char* fmt, va_list ap)
+{
+    assert(sb != nullptr);
+    assert(fmt != nullptr);
+
+    va_list lengthAp;
+    va_copy(lengthAp, ap);
+    int formattedLength = vsnprintf(nullptr, 0, fmt, lengthAp);
+    va_end(lengthAp);
+
+    // the text can't be formatted, e.g. a rune without a representation in the current locale,
+    // so the format text itself is appended in its place.
+    if (formattedLength < 0)
+    {
+        kos_string_builder_append_cstring(sb, fmt);
+        return;
+    }
+
+    if (formattedLength == 0)
+        return;
+
+    // vsnprintf always writes a terminator, so room is made for one past the formatted text.
+    kos_string_builder_ensure_capacity(sb, sb->count + cast(usize) formattedLength + 1);
+    vsnprintf(cast(char*) (sb->memory + sb->count), cast(usize) formattedLength + 1, fmt, ap);
+    sb->count += cast(usize) formattedLength;
+}
+
 void kos_string_builder_set_count(kos_string_builder* sb, usize count)
 {
     assert(sb != nullptr);
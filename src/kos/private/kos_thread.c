@@ -0,0 +1,200 @@
+#ifndef _WIN32
+#  include <pthread.h>
+#  include <unistd.h>
+#else
+#  define WIN32_LEAN_AND_MEAN
+#  include "Windows.h"
+#endif
+
+#include "kos/allocator.h"
+#include "kos/builtins.h"
+#include "kos/thread.h"
+
+struct kos_thread
+{
+    kos_thread_function function;
+    void* argument;
+#ifndef _WIN32
+    pthread_t handle;
+#else
+    HANDLE handle;
+#endif
+};
+
+struct kos_mutex
+{
+#ifndef _WIN32
+    pthread_mutex_t handle;
+#else
+    CRITICAL_SECTION handle;
+#endif
+};
+
+struct kos_condition
+{
+#ifndef _WIN32
+    pthread_cond_t handle;
+#else
+    CONDITION_VARIABLE handle;
+#endif
+};
+
+#ifndef _WIN32
+static void* thread_start(void* argument)
+{
+    kos_thread* t = argument;
+    t->function(t->argument);
+    return nullptr;
+}
+#else
+static DWORD WINAPI thread_start(LPVOID argument)
+{
+    kos_thread* t = argument;
+    t->function(t->argument);
+    return 0;
+}
+#endif
+
+kos_thread* kos_thread_create(kos_thread_function function, void* argument)
+{
+    assert(function != nullptr);
+
+    kos_thread* t = kos_allocate(kos_default_allocator, sizeof(kos_thread));
+    assert(t != nullptr);
+    t->function = function;
+    t->argument = argument;
+
+#ifndef _WIN32
+    if (0 != pthread_create(&t->handle, nullptr, thread_start, t))
+        KOS_INTERNAL_PROGRAM_ERROR("failed to create a thread");
+#else
+    t->handle = CreateThread(nullptr, 0, thread_start, t, 0, nullptr);
+    if (t->handle == nullptr)
+        KOS_INTERNAL_PROGRAM_ERROR("failed to create a thread");
+#endif
+
+    return t;
+}
+
+void kos_thread_join(kos_thread* t)
+{
+    assert(t != nullptr);
+
+#ifndef _WIN32
+    pthread_join(t->handle, nullptr);
+#else
+    WaitForSingleObject(t->handle, INFINITE);
+    CloseHandle(t->handle);
+#endif
+
+    kos_deallocate(kos_default_allocator, t);
+}
+
+usize kos_thread_hardware_concurrency(void)
+{
+#ifndef _WIN32
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? cast(usize) count : 1;
+#else
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwNumberOfProcessors > 0 ? cast(usize) systemInfo.dwNumberOfProcessors : 1;
+#endif
+}
+
+kos_mutex* kos_mutex_create(void)
+{
+    kos_mutex* m = kos_allocate(kos_default_allocator, sizeof(kos_mutex));
+    assert(m != nullptr);
+
+#ifndef _WIN32
+    pthread_mutex_init(&m->handle, nullptr);
+#else
+    InitializeCriticalSection(&m->handle);
+#endif
+
+    return m;
+}
+
+void kos_mutex_destroy(kos_mutex* m)
+{
+    assert(m != nullptr);
+
+#ifndef _WIN32
+    pthread_mutex_destroy(&m->handle);
+#else
+    DeleteCriticalSection(&m->handle);
+#endif
+
+    kos_deallocate(kos_default_allocator, m);
+}
+
+void kos_mutex_lock(kos_mutex* m)
+{
+#ifndef _WIN32
+    pthread_mutex_lock(&m->handle);
+#else
+    EnterCriticalSection(&m->handle);
+#endif
+}
+
+void kos_mutex_unlock(kos_mutex* m)
+{
+#ifndef _WIN32
+    pthread_mutex_unlock(&m->handle);
+#else
+    LeaveCriticalSection(&m->handle);
+#endif
+}
+
+kos_condition* kos_condition_create(void)
+{
+    kos_condition* c = kos_allocate(kos_default_allocator, sizeof(kos_condition));
+    assert(c != nullptr);
+
+#ifndef _WIN32
+    pthread_cond_init(&c->handle, nullptr);
+#else
+    InitializeConditionVariable(&c->handle);
+#endif
+
+    return c;
+}
+
+void kos_condition_destroy(kos_condition* c)
+{
+    assert(c != nullptr);
+
+#ifndef _WIN32
+    pthread_cond_destroy(&c->handle);
+#endif
+
+    kos_deallocate(kos_default_allocator, c);
+}
+
+void kos_condition_wait(kos_condition* c, kos_mutex* m)
+{
+#ifndef _WIN32
+    pthread_cond_wait(&c->handle, &m->handle);
+#else
+    SleepConditionVariableCS(&c->handle, &m->handle, INFINITE);
+#endif
+}
+
+void kos_condition_signal(kos_condition* c)
+{
+#ifndef _WIN32
+    pthread_cond_signal(&c->handle);
+#else
+    WakeConditionVariable(&c->handle);
+#endif
+}
+
+void kos_condition_broadcast(kos_condition* c)
+{
+#ifndef _WIN32
+    pthread_cond_broadcast(&c->handle);
+#else
+    WakeAllConditionVariable(&c->handle);
+#endif
+}
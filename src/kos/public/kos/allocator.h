@@ -12,9 +12,18 @@
 #  define reallocate(allocator, memory, count) kos_reallocate(allocator, memory, count)
 #  define deallocate(allocator, memory) kos_deallocate(allocator, memory)
 #  define arena_create(baseAllocator, blockSize) kos_arena_create(baseAllocator, blockSize)
+#  define arena_create_virtual(baseAllocator, reserveSize) kos_arena_create_virtual(baseAllocator, reserveSize)
 #  define arena_destroy(arena) kos_arena_destroy(arena)
 #  define arena_clear(arena) kos_arena_clear(arena)
+#  define arena_marker kos_arena_marker
+#  define arena_mark(arena) kos_arena_mark(arena)
+#  define arena_rewind(arena, marker) kos_arena_rewind(arena, marker)
 #  define arena_push(arena, count) kos_arena_push(arena, count)
+#  define arena_push_aligned(arena, count, alignment) kos_arena_push_aligned(arena, count, alignment)
+#  define arena_push_uninit(arena, count, alignment) kos_arena_push_uninit(arena, count, alignment)
+#  define arena_stats kos_arena_stats
+#  define arena_get_stats(arena) kos_arena_get_stats(arena)
+#  define arena_stats_add(total, stats) kos_arena_stats_add(total, stats)
 #endif // KOS_NO_SHORT_NAMES
 
 typedef enum kos_allocator_action
@@ -28,6 +37,35 @@ typedef void* (*kos_allocator_function)(kos_allocator_action action, void* memor
 
 typedef struct kos_arena_allocator kos_arena_allocator;
 
+// a position in an arena, see kos_arena_mark.
+typedef struct kos_arena_marker
+{
+    usize blockCount;
+    usize allocated;
+    usize largeBlockCount;
+} kos_arena_marker;
+
+// what an arena has done with its memory, see kos_arena_get_stats.
+typedef struct kos_arena_stats
+{
+    usize pushCount;
+    // the sum of the counts passed to every push.
+    usize requestedBytes;
+    // the bytes currently in use, requested bytes plus alignment padding, less whatever was rewound or cleared.
+    usize usedBytes;
+    // the bytes currently held from the base allocator, or committed by a virtual arena.
+    usize committedBytes;
+    // the most bytes the arena has held at once.
+    usize peakCommittedBytes;
+    // the bytes left unused at the end of a block because the next push didn't fit in it.
+    usize wastedBytes;
+    usize blockCount;
+    usize largeBlockCount;
+} kos_arena_stats;
+
+// the alignment of memory returned by kos_arena_push, enough for any primitive type.
+#define KOS_ARENA_DEFAULT_ALIGNMENT (2 * sizeof(void*))
+
 void* kos_default_allocator(kos_allocator_action action, void* memory, usize count);
 
 void* kos_allocate  (kos_allocator_function allocator, usize count);
@@ -35,8 +73,24 @@ void* kos_reallocate(kos_allocator_function allocator, void* memory, usize count
 void  kos_deallocate(kos_allocator_function allocator, void* memory);
 
 kos_arena_allocator* kos_arena_create(kos_allocator_function baseAllocator, usize blockSize);
+// creates an arena which reserves `reserveSize` bytes of address space up front and commits pages as it fills,
+// so everything pushed to it is contiguous. falls back to a regular arena if the space can't be reserved.
+kos_arena_allocator* kos_arena_create_virtual(kos_allocator_function baseAllocator, usize reserveSize);
 void kos_arena_destroy(kos_arena_allocator* arena);
+// releases everything in the arena except its first block, which is kept for reuse.
 void kos_arena_clear(kos_arena_allocator* arena);
+// records the arena's current position.
+kos_arena_marker kos_arena_mark(kos_arena_allocator* arena);
+// releases everything pushed since `marker` was taken. markers taken after it become invalid.
+void kos_arena_rewind(kos_arena_allocator* arena, kos_arena_marker marker);
+// returns `count` zeroed bytes aligned to KOS_ARENA_DEFAULT_ALIGNMENT.
 void* kos_arena_push(kos_arena_allocator* arena, usize count);
+// returns `count` zeroed bytes aligned to `alignment`, which must be a power of two.
+void* kos_arena_push_aligned(kos_arena_allocator* arena, usize count, usize alignment);
+// like kos_arena_push_aligned, but the memory is not cleared first.
+void* kos_arena_push_uninit(kos_arena_allocator* arena, usize count, usize alignment);
+kos_arena_stats kos_arena_get_stats(kos_arena_allocator* arena);
+// adds every field of `stats` to `total`, so the peak of a total is the sum of the peaks.
+void kos_arena_stats_add(kos_arena_stats* total, kos_arena_stats stats);
 
 #endif // KOS_ALLOCATOR_H
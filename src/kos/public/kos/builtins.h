@@ -12,10 +12,12 @@
 #  define NORETURN __attribute__((noreturn))
 #  define PRETTY_FUNCTION __PRETTY_FUNCTION__
 #  define BUILTIN_UNREACHABLE() __builtin_unreachable()
+#  define ALIGNOF(T) __alignof__(T)
 #else
 #  define NORETURN __declspec(noreturn)
 #  define PRETTY_FUNCTION __FUNCSIG__
 #  define BUILTIN_UNREACHABLE() __assume(0)
+#  define ALIGNOF(T) __alignof(T)
 #endif
 
 #ifdef __EXT_FORMAT__
@@ -1,5 +1,6 @@
 #include "kos/allocator.h"
 #include "kos/builtins.h"
+#include "kos/list.h"
 #include "kos/primitives.h"
 #include "kos/stb_ds.h"
 #include "kos/string.h"
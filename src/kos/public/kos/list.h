@@ -0,0 +1,26 @@
+#ifndef KOS_LIST_H
+#define KOS_LIST_H
+
+#include "kos/allocator.h"
+#include "kos/builtins.h"
+#include "kos/primitives.h"
+
+#ifndef KOS_NO_SHORT_NAMES
+#  define arena_list_init(arena, l, capacity) kos_arena_list_init(arena, l, capacity)
+#endif // KOS_NO_SHORT_NAMES
+
+// every stb_ds container allocates through these rather than through realloc and free directly.
+// lists start out on the default allocator, unless they are created in an arena with kos_arena_list_init.
+#define STBDS_REALLOC(context, memory, count) kos_stb_ds_realloc(memory, count)
+#define STBDS_FREE(context, memory) kos_stb_ds_free(memory)
+
+void* kos_stb_ds_realloc(void* memory, usize count);
+void kos_stb_ds_free(void* memory);
+
+// makes the empty list `l` allocate its elements, with room for `capacity` of them to start with, from `arena`.
+// the list stays in the arena as it grows, and freeing it does nothing since the arena releases its memory.
+// a list which grows after an arena marker is taken must not be used once the arena is rewound to that marker.
+#define kos_arena_list_init(arena, l, capacity) (*cast(void**) &(l) = kos_arena_list_create(arena, sizeof *(l), capacity))
+void* kos_arena_list_create(kos_arena_allocator* arena, usize elementSize, usize capacity);
+
+#endif // KOS_LIST_H
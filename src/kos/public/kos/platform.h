@@ -8,9 +8,13 @@
 #  define PLATFORM_PATH_SEPARATOR KOS_PLATFORM_PATH_SEPARATOR
 #  define platform_read_file_status kos_platform_read_file_status
 #  define platform_read_file(path, allocator, status) kos_platform_read_file(path, allocator, status)
+#  define platform_free_file(file) kos_platform_free_file(file)
+#  define platform_file_identity kos_platform_file_identity
+#  define platform_get_file_identity(path, identity) kos_platform_get_file_identity(path, identity)
 #  define platform_full_path(path) kos_platform_full_path(path)
 #  define platform_path_up(path) kos_platform_path_up(path)
 #  define platform_path_combine(path0, path1) kos_platform_path_combine(path0, path1)
+#  define platform_monotonic_nanoseconds() kos_platform_monotonic_nanoseconds()
 #endif // KOS_NO_SHORT_NAMES
 
 #ifndef _WIN32
@@ -27,11 +31,28 @@ typedef enum kos_platform_read_file_status
     KOS_PLATFORM_READ_FILE_FAILED,
 } kos_platform_read_file_status;
 
+// uniquely identifies a file on this machine, no matter which path or link it was reached through.
+typedef struct kos_platform_file_identity
+{
+    u64 device;
+    u64 inode;
+} kos_platform_file_identity;
+
+// the returned string is always followed by a 0 byte which is not part of its count.
+// when `allocator` is nullptr the file may be memory mapped instead of copied into memory.
+// release the result with kos_platform_free_file either way.
 kos_string kos_platform_read_file(const char* path, kos_allocator_function allocator, kos_platform_read_file_status* status);
+void kos_platform_free_file(kos_string file);
+
+// returns false if the file does not exist or cannot be queried.
+bool kos_platform_get_file_identity(const char* path, kos_platform_file_identity* identity);
 
 kos_string kos_platform_full_path(kos_string_view path);
 
 kos_string_view kos_platform_path_up(kos_string_view path);
 kos_string kos_platform_path_combine(kos_string_view path0, kos_string_view path1);
 
+// nanoseconds since an arbitrary point, which never goes backwards. only differences between readings are meaningful.
+u64 kos_platform_monotonic_nanoseconds(void);
+
 #endif // PLATFORM_H
@@ -0,0 +1,43 @@
+#ifndef KOS_SCAN_H
+#define KOS_SCAN_H
+
+#include "kos/primitives.h"
+
+#ifndef KOS_NO_SHORT_NAMES
+#  define scan_kernel kos_scan_kernel
+#  define SCAN_KERNEL_AUTO KOS_SCAN_KERNEL_AUTO
+#  define SCAN_KERNEL_SCALAR KOS_SCAN_KERNEL_SCALAR
+#  define SCAN_KERNEL_SSE2 KOS_SCAN_KERNEL_SSE2
+#  define SCAN_KERNEL_AVX2 KOS_SCAN_KERNEL_AVX2
+
+#  define scan_select_kernel(kernel) kos_scan_select_kernel(kernel)
+#  define scan_current_kernel() kos_scan_current_kernel()
+#  define scan_skip_whitespace(data, position, count) kos_scan_skip_whitespace(data, position, count)
+#  define scan_find_newline(data, position, count) kos_scan_find_newline(data, position, count)
+#  define scan_find_block_comment_end(data, position, count) kos_scan_find_block_comment_end(data, position, count)
+#endif // KOS_NO_SHORT_NAMES
+
+typedef enum kos_scan_kernel
+{
+    // pick the widest kernel the running CPU supports.
+    KOS_SCAN_KERNEL_AUTO,
+    KOS_SCAN_KERNEL_SCALAR,
+    KOS_SCAN_KERNEL_SSE2,
+    KOS_SCAN_KERNEL_AVX2,
+} kos_scan_kernel;
+
+// selects the kernel used by the kos_scan_* functions. returns false, and leaves the
+// current kernel in place, if the requested kernel is not supported by this CPU or build.
+bool kos_scan_select_kernel(kos_scan_kernel kernel);
+kos_scan_kernel kos_scan_current_kernel(void);
+
+// each function searches `data` from `position` up to `count` bytes and returns `count` if nothing was found.
+
+// returns the index of the first byte which is not ' ', '\t', '\r' or '\n'.
+usize kos_scan_skip_whitespace(const uchar* data, usize position, usize count);
+// returns the index of the first '\n'.
+usize kos_scan_find_newline(const uchar* data, usize position, usize count);
+// returns the index of the '*' in the first "*/" pair.
+usize kos_scan_find_block_comment_end(const uchar* data, usize position, usize count);
+
+#endif // KOS_SCAN_H
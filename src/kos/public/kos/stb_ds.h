@@ -395,6 +395,9 @@ CREDITS
 #ifndef INCLUDE_STB_DS_H
 #define INCLUDE_STB_DS_H
 
+// kos: route every allocation through kos, see kos/list.h.
+#include "kos/list.h"
+
 #include <stddef.h>
 #include <string.h>
 
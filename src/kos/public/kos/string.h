@@ -1,6 +1,8 @@
 #ifndef KOS_STRING_H
 #define KOS_STRING_H
 
+#include <stdarg.h>
+
 #include "kos/allocator.h"
 #include "kos/primitives.h"
 
@@ -42,6 +44,7 @@
 #  define string_view_equals_constant(sv, constant) kos_string_view_equals_constant(sv, constant)
 #  define string_view_ends_with(sv, other) kos_string_view_ends_with(sv, other)
 #  define string_view_ends_with_constant(sv, constant) kos_string_view_ends_with_constant(sv, constant)
+#  define string_view_hash(sv) kos_string_view_hash(sv)
 
 #  define string_builder_init(sb, allocator) kos_string_builder_init(sb, allocator)
 #  define string_builder_deallocate(sb) kos_string_builder_deallocate(sb)
@@ -52,6 +55,9 @@
 #  define string_builder_append_string(sb, s) kos_string_builder_append_string(sb, s)
 #  define string_builder_append_view(sb, value) kos_string_builder_append_view(sb, value)
 #  define string_builder_append_cstring(sb, s) kos_string_builder_append_cstring(sb, s)
+#  define string_builder_append_repeat(sb, value, count) kos_string_builder_append_repeat(sb, value, count)
+#  define string_builder_append_format(sb, ...) kos_string_builder_append_format(sb, __VA_ARGS__)
+#  define string_builder_append_vformat(sb, fmt, ap) kos_string_builder_append_vformat(sb, fmt, ap)
 #  define string_builder_set_count(sb, count) kos_string_builder_set_count(sb, count)
 #endif // KOS_NO_SHORT_NAMES
 
@@ -99,6 +105,8 @@ bool kos_string_view_equals(kos_string_view sv, kos_string_view other);
 bool kos_string_view_equals_constant(kos_string_view sv, const char* constant);
 bool kos_string_view_ends_with(kos_string_view sv, kos_string_view other);
 bool kos_string_view_ends_with_constant(kos_string_view sv, const char* constant);
+// 64-bit FNV-1a hash of the viewed bytes.
+u64 kos_string_view_hash(kos_string_view sv);
 
 void kos_string_builder_init(kos_string_builder* sb, kos_allocator_function allocator);
 void kos_string_builder_deallocate(kos_string_builder* sb);
@@ -110,6 +118,12 @@ void kos_string_builder_append_uint(kos_string_builder* sb, usize value);
 void kos_string_builder_append_string(kos_string_builder* sb, kos_string s);
 void kos_string_builder_append_view(kos_string_builder* sb, kos_string_view value);
 void kos_string_builder_append_cstring(kos_string_builder* sb, const char* s);
+// appends `value` `count` times.
+void kos_string_builder_append_repeat(kos_string_builder* sb, uchar value, usize count);
+// appends the output of printf style formatting, without any nul terminator.
+EXT_FORMAT(2, 3)
+void kos_string_builder_append_format(kos_string_builder* sb, const char* fmt, ...);
+void kos_string_builder_append_vformat(kos_string_builder* sb, const char* fmt, va_list ap);
 void kos_string_builder_set_count(kos_string_builder* sb, usize count);
 
 #endif // KOS_STRING_H
@@ -0,0 +1,57 @@
+#ifndef KOS_THREAD_H
+#define KOS_THREAD_H
+
+#include "kos/primitives.h"
+
+// kos_thread, kos_mutex and kos_condition have no short names, those words are too common as variable names.
+#ifndef KOS_NO_SHORT_NAMES
+#  define THREAD_LOCAL KOS_THREAD_LOCAL
+#  define thread_function kos_thread_function
+
+#  define thread_create(function, argument) kos_thread_create(function, argument)
+#  define thread_join(t) kos_thread_join(t)
+#  define thread_hardware_concurrency() kos_thread_hardware_concurrency()
+#  define mutex_create() kos_mutex_create()
+#  define mutex_destroy(m) kos_mutex_destroy(m)
+#  define mutex_lock(m) kos_mutex_lock(m)
+#  define mutex_unlock(m) kos_mutex_unlock(m)
+#  define condition_create() kos_condition_create()
+#  define condition_destroy(c) kos_condition_destroy(c)
+#  define condition_wait(c, m) kos_condition_wait(c, m)
+#  define condition_signal(c) kos_condition_signal(c)
+#  define condition_broadcast(c) kos_condition_broadcast(c)
+#endif // KOS_NO_SHORT_NAMES
+
+#if __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#  define KOS_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#  define KOS_THREAD_LOCAL __declspec(thread)
+#else
+#  define KOS_THREAD_LOCAL __thread
+#endif
+
+typedef struct kos_thread kos_thread;
+typedef struct kos_mutex kos_mutex;
+typedef struct kos_condition kos_condition;
+
+typedef void (*kos_thread_function)(void* argument);
+
+kos_thread* kos_thread_create(kos_thread_function function, void* argument);
+// waits for the thread to finish, then releases it.
+void kos_thread_join(kos_thread* t);
+// the number of threads the machine can run at once, at least 1.
+usize kos_thread_hardware_concurrency(void);
+
+kos_mutex* kos_mutex_create(void);
+void kos_mutex_destroy(kos_mutex* m);
+void kos_mutex_lock(kos_mutex* m);
+void kos_mutex_unlock(kos_mutex* m);
+
+kos_condition* kos_condition_create(void);
+void kos_condition_destroy(kos_condition* c);
+// `m` must be locked by the calling thread, and is locked again when this returns.
+void kos_condition_wait(kos_condition* c, kos_mutex* m);
+void kos_condition_signal(kos_condition* c);
+void kos_condition_broadcast(kos_condition* c);
+
+#endif // KOS_THREAD_H
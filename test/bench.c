@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+
+typedef struct bench_case
+{
+    const char* name;
+    void (*run)(void);
+} bench_case;
+
+static bench_case benchCases[] = {
+    { "intern", layec_intern_bench },
+    { "lex", laye_lexer_bench },
+    { "arena", kos_arena_bench },
+    { 0 },
+};
+
+void bench_report(const char* name, const char* unit, usize count, u64 nanoseconds)
+{
+    double seconds = cast(double) nanoseconds / 1e9;
+    double rate = seconds > 0 ? cast(double) count / seconds : 0;
+    printf("%-44s %10.2f ms %14.0f %s/s\n", name, seconds * 1e3, rate, unit);
+    fflush(stdout);
+}
+
+// runs every case, or only the ones named on the command line.
+int main(int argc, char** argv)
+{
+    for (usize i = 0; benchCases[i].name != nullptr; i++)
+    {
+        bool isSelected = argc < 2;
+        for (int j = 1; j < argc && !isSelected; j++)
+            isSelected = 0 == strcmp(argv[j], benchCases[i].name);
+
+        if (isSelected)
+            benchCases[i].run();
+    }
+
+    return 0;
+}
@@ -0,0 +1,16 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "kos/kos.h"
+
+// every case is run this many times and its fastest run is reported, the one least disturbed by the rest of the system.
+#define BENCH_RUN_COUNT 5
+
+// prints `count` `unit`s of work done in `nanoseconds` as a rate per second.
+void bench_report(const char* name, const char* unit, usize count, u64 nanoseconds);
+
+void layec_intern_bench(void);
+void laye_lexer_bench(void);
+void kos_arena_bench(void);
+
+#endif // BENCH_H
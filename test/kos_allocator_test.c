@@ -0,0 +1,41 @@
+#include "kos/kos.h"
+
+#include "test.h"
+
+// clearing a virtual arena gives its pages back, and the statistics have to say so on every platform.
+static void kos_allocator_test_virtual_clear(void)
+{
+    arena_allocator* arena = arena_create_virtual(default_allocator, 64 * 1024 * 1024);
+
+    uchar* memory = arena_push(arena, 1024 * 1024);
+    memory[1024 * 1024 - 1] = 1;
+
+    arena_stats stats = arena_get_stats(arena);
+    TEST_CHECK(stats.committedBytes >= 1024 * 1024, "committed %zu bytes after pushing 1 MiB", stats.committedBytes);
+
+    arena_clear(arena);
+
+    stats = arena_get_stats(arena);
+    TEST_CHECK(stats.committedBytes == 0, "committed %zu bytes after clearing", stats.committedBytes);
+    TEST_CHECK(stats.peakCommittedBytes >= 1024 * 1024, "peak of %zu bytes after clearing", stats.peakCommittedBytes);
+
+    // the pages are committed again on demand, and come back zeroed.
+    uchar* reused = arena_push(arena, 64);
+    TEST_CHECK(reused == memory, "the first push after clearing isn't at the start of the arena");
+
+    bool isZeroed = true;
+    for (usize i = 0; i < 64; i++)
+        isZeroed = isZeroed && reused[i] == 0;
+    TEST_CHECK(isZeroed, "memory pushed after clearing isn't zeroed");
+    reused[63] = 1;
+
+    stats = arena_get_stats(arena);
+    TEST_CHECK(stats.committedBytes > 0 && stats.committedBytes < 1024 * 1024, "committed %zu bytes after pushing 64 bytes", stats.committedBytes);
+
+    arena_destroy(arena);
+}
+
+void kos_allocator_test(void)
+{
+    kos_allocator_test_virtual_clear();
+}
@@ -0,0 +1,91 @@
+#include "kos/kos.h"
+#include "kos/platform.h"
+
+#include "bench.h"
+
+// the block size most arenas in the compiler are created with.
+#define ARENA_BENCH_BLOCK_SIZE (64 * 1024)
+
+#define ARENA_BENCH_SMALL_PUSH_COUNT (16 * 1024 * 1024)
+#define ARENA_BENCH_LARGE_PUSH_COUNT (4 * 1024)
+#define ARENA_BENCH_REWIND_COUNT (1024 * 1024)
+
+// pushes the size of a token or a small AST node many times, filling one block after another.
+static u64 arena_bench_small_pushes(void)
+{
+    arena_allocator* arena = arena_create(default_allocator, ARENA_BENCH_BLOCK_SIZE);
+
+    u64 startNanoseconds = platform_monotonic_nanoseconds();
+    for (usize i = 0; i < ARENA_BENCH_SMALL_PUSH_COUNT; i++)
+    {
+        uchar* memory = arena_push(arena, 16);
+        memory[0] = cast(uchar) i;
+    }
+    u64 nanoseconds = platform_monotonic_nanoseconds() - startNanoseconds;
+
+    arena_destroy(arena);
+    return nanoseconds;
+}
+
+// pushes larger than a block, like a long string literal, each between a few small pushes.
+static u64 arena_bench_large_pushes(void)
+{
+    arena_allocator* arena = arena_create(default_allocator, ARENA_BENCH_BLOCK_SIZE);
+
+    u64 startNanoseconds = platform_monotonic_nanoseconds();
+    for (usize i = 0; i < ARENA_BENCH_LARGE_PUSH_COUNT; i++)
+    {
+        uchar* memory = arena_push(arena, 4 * ARENA_BENCH_BLOCK_SIZE);
+        memory[0] = cast(uchar) i;
+
+        for (usize j = 0; j < 4; j++)
+            arena_push(arena, 64);
+    }
+    u64 nanoseconds = platform_monotonic_nanoseconds() - startNanoseconds;
+
+    arena_destroy(arena);
+    return nanoseconds;
+}
+
+// a speculative parse: mark, push a few nodes, then give them back.
+static u64 arena_bench_mark_rewind(void)
+{
+    arena_allocator* arena = arena_create(default_allocator, ARENA_BENCH_BLOCK_SIZE);
+    arena_push(arena, 100);
+
+    u64 startNanoseconds = platform_monotonic_nanoseconds();
+    for (usize i = 0; i < ARENA_BENCH_REWIND_COUNT; i++)
+    {
+        arena_marker marker = arena_mark(arena);
+        for (usize j = 0; j < 8; j++)
+        {
+            uchar* memory = arena_push(arena, 64);
+            memory[0] = cast(uchar) j;
+        }
+        arena_rewind(arena, marker);
+    }
+    u64 nanoseconds = platform_monotonic_nanoseconds() - startNanoseconds;
+
+    arena_destroy(arena);
+    return nanoseconds;
+}
+
+static void arena_bench_run(const char* name, const char* unit, usize count, u64 (*run)(void))
+{
+    u64 fastestNanoseconds = cast(u64) -1;
+    for (usize i = 0; i < BENCH_RUN_COUNT; i++)
+    {
+        u64 nanoseconds = run();
+        if (nanoseconds < fastestNanoseconds)
+            fastestNanoseconds = nanoseconds;
+    }
+
+    bench_report(name, unit, count, fastestNanoseconds);
+}
+
+void kos_arena_bench(void)
+{
+    arena_bench_run("arena: 16M pushes of 16 bytes", "pushes", ARENA_BENCH_SMALL_PUSH_COUNT, arena_bench_small_pushes);
+    arena_bench_run("arena: 4K pushes of 256 KiB, 64 KiB blocks", "pushes", ARENA_BENCH_LARGE_PUSH_COUNT * 5, arena_bench_large_pushes);
+    arena_bench_run("arena: 1M marks, 8 pushes and rewinds", "rewinds", ARENA_BENCH_REWIND_COUNT, arena_bench_mark_rewind);
+}
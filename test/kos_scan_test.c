@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "kos/kos.h"
+#include "kos/scan.h"
+
+#include "test.h"
+
+// every vector kernel must find exactly what the scalar kernel finds, from every start position.
+
+typedef struct scan_test_kernel
+{
+    const char* name;
+    kos_scan_kernel kernel;
+} scan_test_kernel;
+
+static const scan_test_kernel vectorKernels[] = {
+    { "sse2", KOS_SCAN_KERNEL_SSE2 },
+    { "avx2", KOS_SCAN_KERNEL_AVX2 },
+};
+
+static u32 scanTestSeed = 0x2545F491;
+
+static u32 scan_test_random(void)
+{
+    scanTestSeed ^= scanTestSeed << 13;
+    scanTestSeed ^= scanTestSeed >> 17;
+    scanTestSeed ^= scanTestSeed << 5;
+    return scanTestSeed;
+}
+
+static void scan_test_compare(const uchar* data, usize count, const char* description)
+{
+    for (usize position = 0; position <= count; position++)
+    {
+        scan_select_kernel(SCAN_KERNEL_SCALAR);
+        usize expectedWhitespace = scan_skip_whitespace(data, position, count);
+        usize expectedNewline = scan_find_newline(data, position, count);
+        usize expectedCommentEnd = scan_find_block_comment_end(data, position, count);
+
+        for (usize i = 0; i < sizeof vectorKernels / sizeof vectorKernels[0]; i++)
+        {
+            // kernels the CPU or the build doesn't support are skipped.
+            if (!scan_select_kernel(vectorKernels[i].kernel))
+                continue;
+
+            usize whitespace = scan_skip_whitespace(data, position, count);
+            usize newline = scan_find_newline(data, position, count);
+            usize commentEnd = scan_find_block_comment_end(data, position, count);
+
+            TEST_CHECK(whitespace == expectedWhitespace, "%s skip_whitespace on %s (count %zu, position %zu): %zu, expected %zu",
+                vectorKernels[i].name, description, count, position, whitespace, expectedWhitespace);
+            TEST_CHECK(newline == expectedNewline, "%s find_newline on %s (count %zu, position %zu): %zu, expected %zu",
+                vectorKernels[i].name, description, count, position, newline, expectedNewline);
+            TEST_CHECK(commentEnd == expectedCommentEnd, "%s find_block_comment_end on %s (count %zu, position %zu): %zu, expected %zu",
+                vectorKernels[i].name, description, count, position, commentEnd, expectedCommentEnd);
+        }
+    }
+}
+
+// buffers are allocated at exactly `count` bytes, so a kernel reading past the end trips a sanitizer.
+static uchar* scan_test_allocate(usize count, uchar fill)
+{
+    uchar* data = malloc(count == 0 ? 1 : count);
+    memset(data, fill, count);
+    return data;
+}
+
+void kos_scan_test(void)
+{
+    // random runs of the bytes the kernels search for, at every length up to three AVX2 vectors.
+    // every length that isn't a multiple of 16 or 32 ends in a tail shorter than a vector.
+    static const char* alphabets[] = { " \t\r\nx", "*/ \nx", "**//", " \n*/" };
+    for (usize count = 0; count <= 96; count++)
+    {
+        for (usize a = 0; a < sizeof alphabets / sizeof alphabets[0]; a++)
+        {
+            usize alphabetLength = strlen(alphabets[a]);
+            for (usize sample = 0; sample < 8; sample++)
+            {
+                uchar* data = scan_test_allocate(count, 0);
+                for (usize i = 0; i < count; i++)
+                    data[i] = cast(uchar) alphabets[a][scan_test_random() % alphabetLength];
+
+                scan_test_compare(data, count, "random bytes");
+                free(data);
+            }
+        }
+    }
+
+    // a "*/" at every index, including split across every 16 and 32 byte boundary, and a lone '*' in the last byte.
+    for (usize count = 1; count <= 80; count++)
+    {
+        for (usize star = 0; star < count; star++)
+        {
+            uchar* data = scan_test_allocate(count, 'x');
+            data[star] = '*';
+            if (star + 1 < count)
+                data[star + 1] = '/';
+
+            scan_test_compare(data, count, "a single \"*/\"");
+            free(data);
+        }
+    }
+
+    // whitespace which ends at every index, and a newline at every index.
+    for (usize count = 1; count <= 80; count++)
+    {
+        for (usize end = 0; end < count; end++)
+        {
+            uchar* data = scan_test_allocate(count, ' ');
+            data[end] = '\n';
+            scan_test_compare(data, count, "a single newline");
+
+            data[end] = 'x';
+            scan_test_compare(data, count, "whitespace then a non-space");
+            free(data);
+        }
+    }
+
+    scan_select_kernel(SCAN_KERNEL_AUTO);
+}
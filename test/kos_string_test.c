@@ -0,0 +1,27 @@
+#include <string.h>
+#include <wchar.h>
+
+#include "kos/kos.h"
+
+#include "test.h"
+
+// a format vsnprintf rejects, like a non-ASCII %lc outside of a UTF-8 locale, still appends something.
+static void kos_string_test_failed_format(void)
+{
+    string_builder sb = { 0 };
+    string_builder_init(&sb, default_allocator);
+
+    string_builder_append_format(&sb, "[%lc]", cast(wint_t) 0xE9);
+    TEST_CHECK(sb.count > 0, "nothing was appended for a rune which may not format");
+
+    usize countBefore = sb.count;
+    string_builder_append_format(&sb, "%d", 42);
+    TEST_CHECK(sb.count == countBefore + 2 && 0 == memcmp(sb.memory + countBefore, "42", 2), "the builder is unusable after a failed format");
+
+    string_builder_deallocate(&sb);
+}
+
+void kos_string_test(void)
+{
+    kos_string_test_failed_format();
+}
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "kos/kos.h"
+#include "kos/platform.h"
+
+#include "layec/compiler.h"
+
+#include "parser.h"
+
+#include "test.h"
+
+// a cached tree has to load back exactly as it was parsed, and anything wrong with the file it's loaded from
+// has to make the load fail so the file is parsed instead.
+
+static const char astCacheTestSource[] =
+    "import \"other.laye\" as other;\n"
+    "struct Point<T, int N> { i32 x; i32 y; variant Named { string name; } }\n"
+    "enum Color { Red, Green = 2, Blue = 3 + 4 }\n"
+    "export i32 sum(i32[] values, rawptr r) { var total = 0; return total + values[1:2][0]; }\n"
+    "void main(readonly string[] argv) { print(\"cached\"); if argv.length > 1 then return; }\n";
+
+// a different source of the same length, so only its hash tells the two apart.
+static const char astCacheTestOtherSource[] =
+    "import \"other.laye\" as OTHER;\n"
+    "struct Point<T, int N> { i32 x; i32 y; variant Named { string name; } }\n"
+    "enum Color { Red, Green = 2, Blue = 3 + 4 }\n"
+    "export i32 sum(i32[] values, rawptr r) { var total = 0; return total + values[1:2][0]; }\n"
+    "void main(readonly string[] argv) { print(\"cached\"); if argv.length > 1 then return; }\n";
+
+// the cache is written to the working directory, and every file it writes is removed again.
+static const char astCacheTestDirectory[] = ".";
+
+// the path `laye_ast_cache_store` writes the tree of a source with this hash to.
+static const char* ast_cache_test_path(u64 sourceHash)
+{
+    char fileName[32];
+    snprintf(fileName, sizeof fileName, "%016llx.layeast", cast(unsigned long long) sourceHash);
+
+    string_view fileNameView = { .memory = cast(const uchar*) fileName, .count = strlen(fileName) };
+    string path = platform_path_combine(STRING_VIEW_LITERAL(astCacheTestDirectory), fileNameView);
+    const char* pathCString = string_view_to_cstring(string_slice(path, 0, path.count), nullptr);
+    string_deallocate(path);
+    return pathCString;
+}
+
+static void ast_cache_test_write_file(const char* path, const uchar* memory, usize count)
+{
+    FILE* stream = fopen(path, "wb");
+    assert(stream != nullptr);
+    fwrite(memory, 1, count, stream);
+    fclose(stream);
+}
+
+// the text dump of a tree, release it with `free`.
+static char* ast_cache_test_dump(layec_context* context, laye_ast* ast)
+{
+    FILE* stream = tmpfile();
+    assert(stream != nullptr);
+    laye_ast_fprint(stream, context, ast, false);
+
+    long length = ftell(stream);
+    char* dump = malloc(cast(usize) length + 1);
+    rewind(stream);
+    usize readCount = fread(dump, 1, cast(usize) length, stream);
+    dump[readCount] = 0;
+
+    fclose(stream);
+    return dump;
+}
+
+// true if loading the cached tree for `fileId` under `sourceHash` is refused, cleaning up if it wasn't.
+static bool ast_cache_test_load_fails(layec_context* context, layec_fileid fileId, u64 sourceHash)
+{
+    laye_parse_result result = { 0 };
+    if (!laye_ast_cache_load(context, fileId, sourceHash, context->constantArena, &result))
+        return true;
+
+    arena_destroy(result.astArena);
+    return false;
+}
+
+void laye_ast_cache_test(void)
+{
+    layec_context context = { 0 };
+    layec_context_init(&context);
+    context.astCacheDirectory = STRING_VIEW_LITERAL(astCacheTestDirectory);
+
+    layec_fileid fileId = layec_context_add_file_with_source(&context, STRING_VIEW_LITERAL("cached.laye"), STRING_LITERAL(astCacheTestSource));
+    layec_fileid otherFileId = layec_context_add_file_with_source(&context, STRING_VIEW_LITERAL("other.laye"), STRING_LITERAL(astCacheTestOtherSource));
+
+    laye_parse_result parsed = laye_parse(&context, fileId, context.constantArena);
+    TEST_CHECK(parsed.status == LAYE_PARSE_OK, "the test source doesn't parse");
+
+    u64 sourceHash = laye_ast_cache_hash_source(&context, fileId);
+    u64 otherSourceHash = laye_ast_cache_hash_source(&context, otherFileId);
+    TEST_CHECK(sourceHash != otherSourceHash, "the two test sources hash the same");
+
+    laye_ast_cache_store(&context, sourceHash, &parsed.ast);
+
+    const char* path = ast_cache_test_path(sourceHash);
+    const char* otherPath = ast_cache_test_path(otherSourceHash);
+
+    // the file is read into memory of its own, it may be mapped and is about to be rewritten.
+    platform_read_file_status readStatus = 0;
+    string cacheFile = platform_read_file(path, nullptr, &readStatus);
+    TEST_CHECK(readStatus == KOS_PLATFORM_READ_FILE_SUCCESS, "nothing was written to '%s'", path);
+
+    usize cacheCount = readStatus == KOS_PLATFORM_READ_FILE_SUCCESS ? cacheFile.count : 0;
+    uchar* cache = malloc(cacheCount == 0 ? 1 : cacheCount);
+    memcpy(cache, cacheFile.memory, cacheCount);
+    platform_free_file(cacheFile);
+
+    // round trip: the loaded tree dumps exactly like the parsed one.
+    laye_parse_result loaded = { 0 };
+    if (laye_ast_cache_load(&context, fileId, sourceHash, context.constantArena, &loaded))
+    {
+        char* parsedDump = ast_cache_test_dump(&context, &parsed.ast);
+        char* loadedDump = ast_cache_test_dump(&context, &loaded.ast);
+        TEST_CHECK(0 == strcmp(parsedDump, loadedDump), "the loaded tree differs from the parsed one:\n%s\nloaded as:\n%s", parsedDump, loadedDump);
+        free(parsedDump);
+        free(loadedDump);
+        arena_destroy(loaded.astArena);
+    }
+    else TEST_CHECK(false, "the stored tree doesn't load");
+
+    if (cacheCount != 0)
+    {
+        uchar* corrupted = malloc(cacheCount);
+
+        // truncated: every prefix of the file is refused, down to an empty one.
+        for (usize count = 0; count < cacheCount; count++)
+        {
+            ast_cache_test_write_file(path, cache, count);
+            TEST_CHECK(ast_cache_test_load_fails(&context, fileId, sourceHash), "a file truncated to %zu of %zu bytes loads", count, cacheCount);
+        }
+
+        // flipped byte: changing any single byte, in the header or in the payload, is refused.
+        for (usize i = 0; i < cacheCount; i++)
+        {
+            memcpy(corrupted, cache, cacheCount);
+            corrupted[i] ^= 0x01;
+            ast_cache_test_write_file(path, corrupted, cacheCount);
+            TEST_CHECK(ast_cache_test_load_fails(&context, fileId, sourceHash), "a file with byte %zu of %zu flipped loads", i, cacheCount);
+        }
+
+        // version mismatch: the version follows the 8 byte magic, and a file from any other version is refused
+        // even though its payload is intact.
+        memcpy(corrupted, cache, cacheCount);
+        corrupted[8]++;
+        ast_cache_test_write_file(path, corrupted, cacheCount);
+        TEST_CHECK(ast_cache_test_load_fails(&context, fileId, sourceHash), "a file from another cache version loads");
+
+        // file name collision: another source's tree in the file this source's hash names is refused.
+        ast_cache_test_write_file(otherPath, cache, cacheCount);
+        TEST_CHECK(ast_cache_test_load_fails(&context, otherFileId, otherSourceHash), "a tree cached for another source loads by file name");
+
+        // hash collision: a source with the same hash but a different length is refused.
+        ast_cache_test_write_file(path, cache, cacheCount);
+        layec_fileid shorterFileId = layec_context_add_file_with_source(&context, STRING_VIEW_LITERAL("shorter.laye"), STRING_LITERAL("void main() { }\n"));
+        TEST_CHECK(ast_cache_test_load_fails(&context, shorterFileId, sourceHash), "a tree cached for a source of another length loads");
+
+        // after all of that, the intact file still loads.
+        TEST_CHECK(!ast_cache_test_load_fails(&context, fileId, sourceHash), "the intact file no longer loads");
+
+        free(corrupted);
+    }
+
+    free(cache);
+
+    remove(path);
+    remove(otherPath);
+    deallocate(default_allocator, cast(void*) path);
+    deallocate(default_allocator, cast(void*) otherPath);
+
+    if (parsed.astArena != nullptr)
+        arena_destroy(parsed.astArena);
+    layec_context_deinit(&context);
+}
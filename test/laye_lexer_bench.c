@@ -0,0 +1,77 @@
+#include <stdio.h>
+
+#include "kos/kos.h"
+#include "kos/platform.h"
+
+#include "layec/compiler.h"
+
+#include "parser.h"
+
+#include "bench.h"
+
+#define LEXER_BENCH_SOURCE_BYTES (16 * 1024 * 1024)
+
+// a large synthetic source, one function after another with a mix of keywords, names, literals and comments.
+static string lexer_bench_source(void)
+{
+    string_builder sb = { 0 };
+    string_builder_init(&sb, default_allocator);
+
+    for (usize i = 0; sb.count < LEXER_BENCH_SOURCE_BYTES; i++)
+    {
+        string_builder_append_format(&sb,
+            "// computes the value for entry %zu\n"
+            "export i32 compute_entry_%zu(i32 count, readonly string name, u8[*] buffer)\n"
+            "{\n"
+            "    var total = %zu;\n"
+            "    while total < count do { total = total + buffer[total] * 3 - (count / 2); }\n"
+            "    if name.length == 0 then return -1; else print(\"entry %zu\");\n"
+            "    /* a block comment, which is skipped\n"
+            "       without producing any tokens */\n"
+            "    return total + compute_entry_%zu(count - 1, name, buffer);\n"
+            "}\n"
+            "\n",
+            i, i, i * 7, i, i / 2);
+    }
+
+    string source = string_builder_to_string(&sb, default_allocator);
+    string_builder_deallocate(&sb);
+    return source;
+}
+
+// lexes the whole file, returns the number of tokens.
+static usize lexer_bench_lex(layec_context* context, layec_fileid fileId)
+{
+    laye_token_buffer tokens = laye_lex(context, fileId);
+    usize tokenCount = laye_token_buffer_count(&tokens);
+    laye_token_buffer_destroy(&tokens);
+    return tokenCount;
+}
+
+void laye_lexer_bench(void)
+{
+    string source = lexer_bench_source();
+
+    usize tokenCount = 0;
+    u64 fastestNanoseconds = cast(u64) -1;
+    for (usize run = 0; run < BENCH_RUN_COUNT; run++)
+    {
+        layec_context context = { 0 };
+        layec_context_init(&context);
+        layec_fileid fileId = layec_context_add_file_with_source(&context, STRING_VIEW_LITERAL("bench.laye"), source);
+
+        u64 startNanoseconds = platform_monotonic_nanoseconds();
+        tokenCount = lexer_bench_lex(&context, fileId);
+        u64 nanoseconds = platform_monotonic_nanoseconds() - startNanoseconds;
+
+        if (nanoseconds < fastestNanoseconds)
+            fastestNanoseconds = nanoseconds;
+
+        layec_context_deinit(&context);
+    }
+
+    bench_report("lex a 16 MiB synthetic file", "tokens", tokenCount, fastestNanoseconds);
+    bench_report("lex a 16 MiB synthetic file", "bytes", source.count, fastestNanoseconds);
+
+    string_deallocate(source);
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "kos/kos.h"
+#include "kos/platform.h"
+
+#include "layec/compiler.h"
+
+#include "bench.h"
+
+#define INTERN_BENCH_COUNT (1000 * 1000)
+
+// synthetic identifiers shaped like the ones in generated sources, a word and a number.
+static string_view* intern_bench_names(usize count, char** outText)
+{
+    static const char* words[] = { "value", "count", "node", "buffer", "index", "result", "state", "item" };
+
+    char* text = malloc(count * 24);
+    string_view* names = malloc(count * sizeof *names);
+
+    char* cursor = text;
+    for (usize i = 0; i < count; i++)
+    {
+        int length = sprintf(cursor, "%s_%zu", words[i % (sizeof words / sizeof words[0])], i);
+        names[i] = (string_view){ .memory = cast(const uchar*) cursor, .count = cast(usize) length };
+        cursor += length;
+    }
+
+    *outText = text;
+    return names;
+}
+
+// interns INTERN_BENCH_COUNT identifiers into a new context, cycling through `distinctCount` different names.
+static void intern_bench_run(const char* name, usize distinctCount)
+{
+    char* text;
+    string_view* names = intern_bench_names(distinctCount, &text);
+
+    u64 fastestNanoseconds = cast(u64) -1;
+    for (usize run = 0; run < BENCH_RUN_COUNT; run++)
+    {
+        layec_context context = { 0 };
+        layec_context_init(&context);
+
+        u64 startNanoseconds = platform_monotonic_nanoseconds();
+        for (usize i = 0; i < INTERN_BENCH_COUNT; i++)
+            layec_intern_symbol(&context, names[i % distinctCount]);
+        u64 nanoseconds = platform_monotonic_nanoseconds() - startNanoseconds;
+
+        if (nanoseconds < fastestNanoseconds)
+            fastestNanoseconds = nanoseconds;
+
+        layec_context_deinit(&context);
+    }
+
+    bench_report(name, "identifiers", INTERN_BENCH_COUNT, fastestNanoseconds);
+
+    free(names);
+    free(text);
+}
+
+void layec_intern_bench(void)
+{
+    intern_bench_run("intern 1M identifiers, 16K distinct", 16 * 1024);
+    intern_bench_run("intern 1M identifiers, all distinct", INTERN_BENCH_COUNT);
+}
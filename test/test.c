@@ -0,0 +1,31 @@
+#include <stdio.h>
+
+#include "test.h"
+
+usize testFailureCount = 0;
+
+typedef struct test_case
+{
+    const char* name;
+    void (*run)(void);
+} test_case;
+
+static test_case testCases[] = {
+    { "kos_allocator", kos_allocator_test },
+    { "kos_scan", kos_scan_test },
+    { "kos_string", kos_string_test },
+    { "laye_ast_cache", laye_ast_cache_test },
+    { 0 },
+};
+
+int main(void)
+{
+    for (usize i = 0; testCases[i].name != nullptr; i++)
+    {
+        usize failureCountBefore = testFailureCount;
+        testCases[i].run();
+        fprintf(stderr, "%s: %s\n", testCases[i].name, testFailureCount == failureCountBefore ? "passed" : "FAILED");
+    }
+
+    return testFailureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+#include "kos/kos.h"
+
+// the number of checks which have failed so far, a test keeps running after one so every mismatch is reported.
+extern usize testFailureCount;
+
+#define TEST_CHECK(condition, ...) \
+    do { \
+        if (!(condition)) \
+        { \
+            testFailureCount++; \
+            fprintf(stderr, "%s:%d: check failed: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+        } \
+    } while (0)
+
+void kos_allocator_test(void);
+void kos_scan_test(void);
+void kos_string_test(void);
+void laye_ast_cache_test(void);
+
+#endif // TEST_H